@@ -19,16 +19,156 @@
 #include <QProcess>
 #include <QDebug>
 #include <QMap>
+#include <QSet>
 #include <QComboBox>
 #include <QLabel>
 #include <QTextEdit>
 #include <QRegularExpression> // NEW: Include QRegularExpression for modern split
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QTimer>
+#include <QDateTime>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
 #include <intrin.h>
+#else
+#include <unistd.h>
 #endif
 
+// Lightweight span tracer. When disabled a TRACE_SCOPE costs one relaxed atomic
+// load; when enabled, finished spans go to a per-thread buffer and can be dumped
+// as Chrome/Perfetto trace JSON (load it in chrome://tracing or ui.perfetto.dev).
+class Trace {
+public:
+    struct Event {
+        const char *name;
+        QString detail;
+        qint64 startUs;
+        qint64 durUs;
+    };
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    static qint64 nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    static void record(const char *name, const QString &detail, qint64 startUs, qint64 durUs) {
+        Buffer &buf = localBuffer();
+        std::lock_guard<std::mutex> lock(buf.mutex); // uncontended except while dumping
+        buf.events.push_back({name, detail, startUs, durUs});
+    }
+
+    static void clear() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto &buf : buffers) {
+            std::lock_guard<std::mutex> bufLock(buf->mutex);
+            buf->events.clear();
+        }
+    }
+
+    static bool writeJson(const QString &path) {
+        QJsonArray events;
+        const qint64 pid = QCoreApplication::applicationPid();
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            for (auto &buf : buffers) {
+                std::lock_guard<std::mutex> bufLock(buf->mutex);
+                for (const Event &e : buf->events) {
+                    QJsonObject ev;
+                    ev["name"] = e.name;
+                    ev["cat"] = "qmgr";
+                    ev["ph"] = "X";
+                    ev["ts"] = e.startUs;
+                    ev["dur"] = e.durUs;
+                    ev["pid"] = pid;
+                    ev["tid"] = buf->tid;
+                    if (!e.detail.isEmpty()) ev["args"] = QJsonObject{{"detail", e.detail}};
+                    events.append(ev);
+                }
+            }
+        }
+        QJsonObject root;
+        root["traceEvents"] = events;
+        root["displayTimeUnit"] = "ms";
+
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        return f.commit();
+    }
+
+private:
+    struct Buffer {
+        qint64 tid;
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    static Buffer &localBuffer() {
+        thread_local std::shared_ptr<Buffer> buf = [] {
+            auto b = std::make_shared<Buffer>();
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            b->tid = static_cast<qint64>(buffers.size()) + 1;
+            buffers.push_back(b);
+            return b;
+        }();
+        return *buf;
+    }
+
+    static inline std::atomic<bool> enabled{false};
+    static inline const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    static inline std::mutex buffersMutex;
+    static inline std::vector<std::shared_ptr<Buffer>> buffers;
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name) : m_name(Trace::isEnabled() ? name : nullptr) {
+        if (m_name) m_start = Trace::nowUs();
+    }
+    TraceSpan(const char *name, const QString &detail) : TraceSpan(name) {
+        if (m_name) m_detail = detail;
+    }
+    ~TraceSpan() { end(); }
+
+    // Closes the span early, e.g. before a modal dialog that should not count.
+    void end() {
+        if (m_name) Trace::record(m_name, m_detail, m_start, Trace::nowUs() - m_start);
+        m_name = nullptr;
+    }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    QString m_detail;
+    qint64 m_start = 0;
+};
+
+#define QMGR_TRACE_CAT2(a, b) a##b
+#define QMGR_TRACE_CAT(a, b) QMGR_TRACE_CAT2(a, b)
+// TRACE_SCOPE("name") or TRACE_SCOPE("name", detailString); spans end at scope exit.
+#define TRACE_SCOPE(...) TraceSpan QMGR_TRACE_CAT(traceSpan_, __LINE__)(__VA_ARGS__)
+// Slots use a named TraceSpan started after their modal input and end() it before
+// any message box, so spans measure qmgr's work rather than the user.
+
 struct VM {
     QString name;
     QString disk;
@@ -44,8 +184,30 @@ struct VM {
     bool accel_override = false;
     QString accel_type = "default";
     QString custom_args; // NEW: Custom QEMU arguments
+    // I/O throttling for the primary HDD. Limits of 0 mean unlimited.
+    bool throttle = false;
+    int throttle_bps = 0;       // MB/s
+    int throttle_iops = 0;
+    int throttle_bps_max = 0;   // burst MB/s
+    int throttle_iops_max = 0;  // burst IOPS
+    int throttle_burst_len = 1; // seconds a burst may last
+    // Pre-launched instance pool using this VM as a template. pool_size 0 = off.
+    int pool_size = 0;
+    int pool_mem_limit = 0; // MB across all pooled instances, 0 = no limit
+    int pool_boot_secs = 0; // 0 = hold at -S before firmware; else boot this long, then pause
+    QString backing_disk;   // set on VMs taken from a pool: disk is an overlay of this image
+    // Launch profile: "desktop" (legacy PC with menu, VGA, USB tablet, SDL),
+    // "server" (q35, virtio, headless) or "microvm" (minimal machine, direct kernel boot).
+    QString profile = "desktop";
+    QString kernel; // direct kernel boot, optional except for microvm
+    QString initrd;
+    QString kernel_append;
 };
 
+// Block backend and guest device ids used for the primary HDD, so QMP can address it.
+static const char *const primaryDriveId = "hd0";
+static const char *const primaryDeviceId = "disk0";
+
 static QString getDatabasePath() {
     return QDir(QCoreApplication::applicationDirPath()).filePath("database.ini");
 }
@@ -88,6 +250,7 @@ static QString findQemuImgExecutable() {
 }
 
 static void vmToSettings(const VM &vm) {
+    TRACE_SCOPE("vmToSettings", vm.name);
     QSettings s(getDatabasePath(), QSettings::IniFormat);
     s.beginGroup(vm.name);
     s.setValue("disk", vm.disk);
@@ -103,11 +266,26 @@ static void vmToSettings(const VM &vm) {
     s.setValue("accel_override", vm.accel_override ? 1 : 0);
     s.setValue("accel_type", vm.accel_type);
     s.setValue("custom_args", vm.custom_args); // NEW
+    s.setValue("throttle", vm.throttle ? 1 : 0);
+    s.setValue("throttle_bps", vm.throttle_bps);
+    s.setValue("throttle_iops", vm.throttle_iops);
+    s.setValue("throttle_bps_max", vm.throttle_bps_max);
+    s.setValue("throttle_iops_max", vm.throttle_iops_max);
+    s.setValue("throttle_burst_len", vm.throttle_burst_len);
+    s.setValue("pool_size", vm.pool_size);
+    s.setValue("pool_mem_limit", vm.pool_mem_limit);
+    s.setValue("pool_boot_secs", vm.pool_boot_secs);
+    s.setValue("backing_disk", vm.backing_disk);
+    s.setValue("profile", vm.profile);
+    s.setValue("kernel", vm.kernel);
+    s.setValue("initrd", vm.initrd);
+    s.setValue("kernel_append", vm.kernel_append);
     s.endGroup();
     s.sync();
 }
 
 static VM vmFromSettings(const QString &name) {
+    TRACE_SCOPE("vmFromSettings", name);
     QSettings s(getDatabasePath(), QSettings::IniFormat);
     s.beginGroup(name);
     VM vm;
@@ -125,10 +303,744 @@ static VM vmFromSettings(const QString &name) {
     vm.accel_override = s.value("accel_override", 0).toInt() == 1;
     vm.accel_type = s.value("accel_type", "default").toString();
     vm.custom_args = s.value("custom_args", "").toString(); // NEW
+    vm.throttle = s.value("throttle", 0).toInt() == 1;
+    vm.throttle_bps = s.value("throttle_bps", 0).toInt();
+    vm.throttle_iops = s.value("throttle_iops", 0).toInt();
+    vm.throttle_bps_max = s.value("throttle_bps_max", 0).toInt();
+    vm.throttle_iops_max = s.value("throttle_iops_max", 0).toInt();
+    vm.throttle_burst_len = s.value("throttle_burst_len", 1).toInt();
+    vm.pool_size = s.value("pool_size", 0).toInt();
+    vm.pool_mem_limit = s.value("pool_mem_limit", 0).toInt();
+    vm.pool_boot_secs = s.value("pool_boot_secs", 0).toInt();
+    vm.backing_disk = s.value("backing_disk", "").toString();
+    vm.profile = s.value("profile", "desktop").toString();
+    vm.kernel = s.value("kernel", "").toString();
+    vm.initrd = s.value("initrd", "").toString();
+    vm.kernel_append = s.value("kernel_append", "").toString();
     s.endGroup();
     return vm;
 }
 
+static QStringList vmNames() {
+    TRACE_SCOPE("QSettings::childGroups");
+    QSettings s(getDatabasePath(), QSettings::IniFormat);
+    return s.childGroups();
+}
+
+static bool sameThrottle(const VM &a, const VM &b) {
+    return a.throttle == b.throttle
+        && a.throttle_bps == b.throttle_bps && a.throttle_iops == b.throttle_iops
+        && a.throttle_bps_max == b.throttle_bps_max && a.throttle_iops_max == b.throttle_iops_max
+        && a.throttle_burst_len == b.throttle_burst_len;
+}
+
+// A VM's QMP monitor is unauthenticated, so outside Windows it listens on a unix
+// socket in a directory only this user can enter. QEMU on Windows has no usable
+// alternative, so there it is a localhost TCP port. Endpoints are the socket
+// path or the port number as a string; empty means no QMP.
+#ifdef Q_OS_WIN
+typedef QTcpSocket QmpSocket;
+#else
+typedef QLocalSocket QmpSocket;
+#endif
+
+static QString newQmpEndpoint() {
+#ifdef Q_OS_WIN
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, 0)) return QString();
+    QString port = QString::number(server.serverPort());
+    server.close();
+    return port;
+#else
+    QString base = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (base.isEmpty()) base = QDir::tempPath();
+    QString dir = QDir(base).filePath(QString("qmgr-%1").arg(getuid()));
+    QDir().mkpath(dir);
+    // Refuse a directory someone else created or redirected for us.
+    QFileInfo info(dir);
+    if (!info.isDir() || info.isSymLink() || info.ownerId() != getuid()
+        || !QFile::setPermissions(dir, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner))
+        return QString();
+    static int counter = 0;
+    QString path = QDir(dir).filePath(QString("qmp-%1-%2.sock").arg(QCoreApplication::applicationPid()).arg(++counter));
+    QFile::remove(path);
+    return path;
+#endif
+}
+
+static QString qmpChardevArg(const QString &endpoint) {
+#ifdef Q_OS_WIN
+    return QString("tcp:127.0.0.1:%1,server=on,wait=off").arg(endpoint);
+#else
+    return QString("unix:%1,server=on,wait=off").arg(QString(endpoint).replace(",", ",,"));
+#endif
+}
+
+static void connectQmpSocket(QmpSocket &sock, const QString &endpoint) {
+#ifdef Q_OS_WIN
+    sock.connectToHost(QHostAddress::LocalHost, endpoint.toUShort());
+#else
+    sock.connectToServer(endpoint);
+#endif
+}
+
+// Runs one QMP command against the monitor at endpoint.
+// Returns the "return" member; on failure returns undefined and fills *error.
+static QJsonValue qmpExecute(const QString &endpoint, const QString &command,
+                             const QJsonObject &arguments = QJsonObject(), QString *error = nullptr) {
+    TRACE_SCOPE("qmpExecute", command);
+    QmpSocket sock;
+    bool connected = false;
+    // QEMU may still be setting up its chardevs right after launch.
+    for (int attempt = 0; attempt < 30 && !endpoint.isEmpty(); ++attempt) {
+        connectQmpSocket(sock, endpoint);
+        connected = sock.waitForConnected(1000);
+        if (connected) break;
+        sock.abort();
+        QThread::msleep(100);
+    }
+    if (!connected) {
+        if (error) *error = "Could not connect to QMP: " + sock.errorString();
+        return QJsonValue(QJsonValue::Undefined);
+    }
+
+    // Reads the next reply, skipping asynchronous events.
+    auto readReply = [&sock]() -> QJsonObject {
+        for (;;) {
+            while (!sock.canReadLine()) {
+                if (!sock.waitForReadyRead(5000)) return QJsonObject();
+            }
+            QJsonObject obj = QJsonDocument::fromJson(sock.readLine()).object();
+            if (!obj.contains("event")) return obj;
+        }
+    };
+    auto send = [&sock](const QString &cmd, const QJsonObject &cmdArgs) {
+        QJsonObject req;
+        req["execute"] = cmd;
+        if (!cmdArgs.isEmpty()) req["arguments"] = cmdArgs;
+        sock.write(QJsonDocument(req).toJson(QJsonDocument::Compact) + "\n");
+        sock.flush();
+    };
+
+    if (!readReply().contains("QMP")) {
+        if (error) *error = "No QMP greeting received.";
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    send("qmp_capabilities", QJsonObject());
+    if (!readReply().contains("return")) {
+        if (error) *error = "QMP capabilities negotiation failed.";
+        return QJsonValue(QJsonValue::Undefined);
+    }
+
+    send(command, arguments);
+    QJsonObject reply = readReply();
+    if (!reply.contains("return")) {
+        if (error) {
+            QString desc = reply.value("error").toObject().value("desc").toString();
+            *error = desc.isEmpty() ? QString("No reply to QMP command '%1'.").arg(command) : desc;
+        }
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return reply.value("return");
+}
+
+// Asynchronous counterpart of qmpExecute for work driven from the GUI thread.
+// Keeps one connection open and runs queued commands in order; each callback
+// gets the "return" member, or undefined and an error message. A QEMU monitor
+// serves one client at a time, so delete the client before using qmpExecute on
+// the same endpoint. Release clients with deleteLater() from inside a callback;
+// callbacks still queued on a deleted client are not called.
+class QmpClient : public QObject {
+public:
+    typedef std::function<void(const QJsonValue &result, const QString &error)> Callback;
+
+    explicit QmpClient(const QString &endpoint, QObject *parent = nullptr) : QObject(parent), m_endpoint(endpoint) {
+        m_retry.setInterval(100);
+        m_timeout.setSingleShot(true);
+        m_timeout.setInterval(10000);
+        connect(&m_retry, &QTimer::timeout, this, [this] { tryConnect(); });
+        connect(&m_timeout, &QTimer::timeout, this, [this] { fail("QMP did not answer."); });
+        connect(&m_sock, &QmpSocket::connected, this, [this] {
+            m_retry.stop();
+            m_state = Greeting;
+            m_timeout.start();
+        });
+        connect(&m_sock, &QmpSocket::readyRead, this, [this] { onReadyRead(); });
+        connect(&m_sock, &QmpSocket::disconnected, this, [this] { fail("QMP connection closed."); });
+        if (m_endpoint.isEmpty()) {
+            fail("The VM has no QMP endpoint.");
+            return;
+        }
+        // QEMU may still be setting up its chardevs right after launch.
+        m_retry.start();
+        tryConnect();
+    }
+
+    ~QmpClient() override {
+        m_sock.disconnect(this);
+        m_sock.abort();
+    }
+
+    void execute(const QString &command, const QJsonObject &arguments, Callback done) {
+        m_queue.append(Pending{command, arguments, done});
+        if (m_state == Failed) QTimer::singleShot(0, this, [this] { fail(m_error); });
+        else sendNext();
+    }
+
+private:
+    enum State { Connecting, Greeting, Negotiating, Ready, Failed };
+    struct Pending {
+        QString command;
+        QJsonObject arguments;
+        Callback done;
+    };
+
+    void tryConnect() {
+        if (m_sock.state() != QmpSocket::UnconnectedState) return;
+        if (++m_attempts > 100) {
+            fail("Could not connect to QMP: " + m_sock.errorString());
+            return;
+        }
+        connectQmpSocket(m_sock, m_endpoint);
+    }
+
+    void send(const QString &command, const QJsonObject &arguments) {
+        QJsonObject req;
+        req["execute"] = command;
+        if (!arguments.isEmpty()) req["arguments"] = arguments;
+        m_sock.write(QJsonDocument(req).toJson(QJsonDocument::Compact) + "\n");
+        m_timeout.start();
+    }
+
+    void sendNext() {
+        if (m_state != Ready || m_busy || m_queue.isEmpty()) return;
+        m_busy = true;
+        send(m_queue.first().command, m_queue.first().arguments);
+    }
+
+    void onReadyRead() {
+        while (m_state != Failed && m_sock.canReadLine()) {
+            QJsonObject reply = QJsonDocument::fromJson(m_sock.readLine()).object();
+            if (reply.contains("event")) continue;
+            m_timeout.stop();
+            if (m_state == Greeting) {
+                if (!reply.contains("QMP")) { fail("No QMP greeting received."); return; }
+                m_state = Negotiating;
+                send("qmp_capabilities", QJsonObject());
+            } else if (m_state == Negotiating) {
+                if (!reply.contains("return")) { fail("QMP capabilities negotiation failed."); return; }
+                m_state = Ready;
+                sendNext();
+            } else if (m_busy) {
+                Pending p = m_queue.takeFirst();
+                m_busy = false;
+                if (reply.contains("return")) {
+                    p.done(reply.value("return"), QString());
+                } else {
+                    QString desc = reply.value("error").toObject().value("desc").toString();
+                    p.done(QJsonValue(QJsonValue::Undefined),
+                           desc.isEmpty() ? QString("No reply to QMP command '%1'.").arg(p.command) : desc);
+                }
+                sendNext();
+            }
+        }
+    }
+
+    // Fails every queued command; later commands fail the same way.
+    void fail(const QString &error) {
+        if (m_state != Failed) {
+            m_state = Failed;
+            m_error = error;
+            m_retry.stop();
+            m_timeout.stop();
+            m_sock.abort();
+        }
+        QList<Pending> pending;
+        pending.swap(m_queue);
+        m_busy = false;
+        for (const Pending &p : pending) p.done(QJsonValue(QJsonValue::Undefined), m_error);
+    }
+
+    QString m_endpoint;
+    QmpSocket m_sock;
+    QTimer m_retry;
+    QTimer m_timeout;
+    State m_state = Connecting;
+    QString m_error;
+    int m_attempts = 0;
+    bool m_busy = false;
+    QList<Pending> m_queue;
+};
+
+// Pushes the VM's throttle settings to a running QEMU; all-zero limits disable throttling.
+static bool applyIoThrottle(const QString &qmp, const VM &vm, QString *error) {
+    const qint64 mb = 1024 * 1024;
+    QJsonObject a;
+    a["id"] = primaryDeviceId;
+    a["bps"] = vm.throttle ? vm.throttle_bps * mb : 0;
+    a["bps_rd"] = 0;
+    a["bps_wr"] = 0;
+    a["iops"] = vm.throttle ? vm.throttle_iops : 0;
+    a["iops_rd"] = 0;
+    a["iops_wr"] = 0;
+    if (vm.throttle) {
+        a["bps_max"] = vm.throttle_bps_max * mb;
+        a["iops_max"] = vm.throttle_iops_max;
+        // QEMU rejects a burst length without a burst limit.
+        if (vm.throttle_bps_max > 0) a["bps_max_length"] = vm.throttle_burst_len;
+        if (vm.throttle_iops_max > 0) a["iops_max_length"] = vm.throttle_burst_len;
+    }
+    return !qmpExecute(qmp, "block_set_io_throttle", a, error).isUndefined();
+}
+
+// Launch-time equivalent of applyIoThrottle, as -drive suboptions.
+static QString throttleDriveOptions(const VM &vm) {
+    if (!vm.throttle) return QString();
+    const qint64 mb = 1024 * 1024;
+    QString opts;
+    if (vm.throttle_bps > 0) opts += QString(",throttling.bps-total=%1").arg(vm.throttle_bps * mb);
+    if (vm.throttle_iops > 0) opts += QString(",throttling.iops-total=%1").arg(vm.throttle_iops);
+    if (vm.throttle_bps_max > 0)
+        opts += QString(",throttling.bps-total-max=%1,throttling.bps-total-max-length=%2")
+                    .arg(vm.throttle_bps_max * mb).arg(vm.throttle_burst_len);
+    if (vm.throttle_iops_max > 0)
+        opts += QString(",throttling.iops-total-max=%1,throttling.iops-total-max-length=%2")
+                    .arg(vm.throttle_iops_max).arg(vm.throttle_burst_len);
+    return opts;
+}
+
+// Command line for a VM; shared by onLaunch and the pre-launched pool so both
+// produce identical guests. An empty qmp endpoint means no QMP socket.
+static QStringList buildQemuArgs(const VM &vm, const QString &qmp) {
+    QStringList args;
+    const bool microvm = vm.profile == "microvm";
+    const bool desktop = !microvm && vm.profile != "server";
+
+    // Headless profiles skip the boot menu wait, legacy VGA/USB (the polled
+    // usb-tablet costs host CPU even on idle guests) and use virtio devices.
+    if (microvm) args << "-machine" << "microvm" << "-nodefaults" << "-no-user-config";
+    else if (!desktop) args << "-machine" << "q35";
+
+    QString accelArg;
+    if (vm.accel_override && vm.accel_type != "default") {
+        accelArg = vm.accel_type;
+    } else {
+#ifdef Q_OS_WIN
+        accelArg = hasVirtualization() ? "whpx" : "tcg";
+#else
+        accelArg = hasVirtualization() ? "kvm" : "tcg";
+#endif
+    }
+    
+#ifdef Q_OS_WIN
+    if (accelArg == "kvm") {
+        accelArg = hasVirtualization() ? "whpx" : "tcg";
+    }
+#else
+    if (accelArg == "whpx" || accelArg == "hax") {
+        accelArg = hasVirtualization() ? "kvm" : "tcg";
+    }
+#endif
+    
+    args << "-accel" << accelArg;
+
+
+    args << "-m" << QString::number(vm.mem);
+    if (!vm.cpu.trimmed().isEmpty())
+        args << "-cpu" << vm.cpu;
+
+    if (!vm.kernel.isEmpty()) {
+        args << "-kernel" << vm.kernel;
+        if (!vm.initrd.isEmpty()) args << "-initrd" << vm.initrd;
+        QString append = vm.kernel_append;
+        if (append.isEmpty() && !desktop) append = "console=ttyS0";
+        if (!append.isEmpty()) args << "-append" << append;
+    }
+
+    if (vm.hda) {
+        // Equivalent to -hda, but with ids so QMP can throttle and query the disk.
+        args << "-drive" << QString("file=%1,if=none,id=%2").arg(QString(vm.disk).replace(",", ",,"), primaryDriveId)
+                            + throttleDriveOptions(vm);
+        if (desktop)
+            args << "-device" << QString("ide-hd,drive=%1,bus=ide.0,unit=0,id=%2").arg(primaryDriveId, primaryDeviceId);
+        else
+            args << "-device" << QString("%1,drive=%2,id=%3").arg(microvm ? "virtio-blk-device" : "virtio-blk-pci",
+                                                                 primaryDriveId, primaryDeviceId);
+    }
+    if (!vm.iso.isEmpty() && !microvm) args << "-cdrom" << vm.iso;
+
+    if (desktop) {
+        args << "-boot" << "menu=on";
+        args << "-vga" << "std";
+        args << "-usb" << "-device" << "usb-tablet";
+    }
+    args << "-name" << vm.name;
+
+    if (vm.net) {
+        if (desktop)
+            args << "-net" << "nic" << "-net" << "user";
+        else
+            args << "-netdev" << "user,id=net0"
+                 << "-device" << QString("%1,netdev=net0").arg(microvm ? "virtio-net-device" : "virtio-net-pci");
+    }
+
+    if (vm.audio && desktop) {
+#ifdef Q_OS_WIN
+        args << "-audiodev" << "dsound,id=snd0"
+             << "-device" << "ich9-intel-hda"
+             << "-device" << "hda-output,audiodev=snd0";
+#else
+        args << "-audiodev" << "pa,id=snd0"
+             << "-device" << "ich9-intel-hda"
+             << "-device" << "hda-output,audiodev=snd0";
+#endif
+    }
+
+    if (vm.vnc && !microvm) {
+        QString vncArg = QString(":%1").arg(vm.vnc_port - 5900);
+        if (vm.vnc_pass) vncArg += ",password=on";
+        args << "-vnc" << vncArg;
+    }
+
+    // Default display and monitor setup (moved from the VNC block)
+    if (desktop || (vm.vnc && !microvm)) {
+        if (!vm.vnc) {
+             args << "-display" << "sdl";
+        }
+        args << "-monitor" << "stdio";
+    } else {
+        // No display: serial console and monitor share the terminal.
+        args << "-display" << "none";
+        if (!microvm) args << "-vga" << "none";
+        args << "-serial" << "mon:stdio";
+    }
+
+    if (!qmp.isEmpty())
+        args << "-qmp" << qmpChardevArg(qmp);
+
+    // FIX: Replaced deprecated QString::split(QRegExp, SplitBehavior) with modern QString::split(QRegularExpression, Qt::SplitBehavior)
+    if (!vm.custom_args.isEmpty()) {
+        QRegularExpression rx("\\s+"); // Matches one or more whitespace characters
+        QStringList customArgs = vm.custom_args.split(rx, Qt::SkipEmptyParts);
+        args << customArgs;
+    }
+    return args;
+}
+
+// Collect per-disk latency histograms (ns buckets: 10us .. 1s) for "Disk Stats".
+// Failure is not fatal: "Disk Stats" then reports that no histograms are available.
+static void enableLatencyHistogram(QmpClient *qmp, const VM &vm, QmpClient::Callback done) {
+    if (!vm.hda) {
+        done(QJsonValue(QJsonValue::Undefined), "The VM has no primary HDD.");
+        return;
+    }
+    QJsonObject histArgs;
+    histArgs["id"] = primaryDeviceId;
+    histArgs["boundaries"] = QJsonArray{10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    qmp->execute("block-latency-histogram-set", histArgs, done);
+}
+
+// Writes <folder>/<name>.ini for onImport. backupChain lists the incremental
+// export images, full image first; onImport flattens it back into one disk.
+static void vmToExportSettings(const VM &vm, const QString &folder, const QStringList &backupChain = QStringList()) {
+    QSettings exportSettings(QDir(folder).filePath(vm.name + ".ini"), QSettings::IniFormat);
+    exportSettings.beginGroup(vm.name);
+    exportSettings.setValue("disk", QFileInfo(vm.disk).fileName());
+    exportSettings.setValue("iso", QFileInfo(vm.iso).fileName());
+    exportSettings.setValue("mem", vm.mem);
+    exportSettings.setValue("cpu", vm.cpu);
+    exportSettings.setValue("net", vm.net ? 1 : 0);
+    exportSettings.setValue("audio", vm.audio ? 1 : 0);
+    exportSettings.setValue("hda", vm.hda ? 1 : 0);
+    exportSettings.setValue("vnc", vm.vnc ? 1 : 0);
+    exportSettings.setValue("vnc_port", vm.vnc_port);
+    exportSettings.setValue("vnc_pass", vm.vnc_pass ? 1 : 0);
+    exportSettings.setValue("accel_override", vm.accel_override ? 1 : 0);
+    exportSettings.setValue("accel_type", vm.accel_type);
+    exportSettings.setValue("custom_args", vm.custom_args); // NEW
+    exportSettings.setValue("throttle", vm.throttle ? 1 : 0);
+    exportSettings.setValue("throttle_bps", vm.throttle_bps);
+    exportSettings.setValue("throttle_iops", vm.throttle_iops);
+    exportSettings.setValue("throttle_bps_max", vm.throttle_bps_max);
+    exportSettings.setValue("throttle_iops_max", vm.throttle_iops_max);
+    exportSettings.setValue("throttle_burst_len", vm.throttle_burst_len);
+    exportSettings.setValue("pool_size", vm.pool_size);
+    exportSettings.setValue("pool_mem_limit", vm.pool_mem_limit);
+    exportSettings.setValue("pool_boot_secs", vm.pool_boot_secs);
+    exportSettings.setValue("profile", vm.profile);
+    exportSettings.setValue("kernel", vm.kernel);
+    exportSettings.setValue("initrd", vm.initrd);
+    exportSettings.setValue("kernel_append", vm.kernel_append);
+    if (backupChain.isEmpty()) exportSettings.remove("backup_chain");
+    else exportSettings.setValue("backup_chain", backupChain);
+    exportSettings.endGroup();
+    exportSettings.sync();
+}
+
+// A path in dir for fileName that no existing file uses, so imports never
+// overwrite a disk or ISO: "name.qcow2", then "name-2.qcow2", "name-3.qcow2", ...
+static QString uniqueFilePath(const QDir &dir, const QString &fileName) {
+    QFileInfo info(fileName);
+    QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    QString path = dir.filePath(fileName);
+    for (int n = 2; QFileInfo::exists(path); ++n)
+        path = dir.filePath(QString("%1-%2%3").arg(info.completeBaseName()).arg(n).arg(suffix));
+    return path;
+}
+
+// Incremental backup support. A persistent dirty bitmap on the qcow2 disk
+// records which clusters changed since the last export; QMP blockdev-backup
+// then copies only those into a new overlay on top of the previous one.
+static const char *const backupBitmapName = "qmgr-backup";
+static const char *const backupTargetNode = "qmgr-backup-target";
+static const char *const backupJobId = "qmgr-backup";
+
+static bool runQemuImg(const QStringList &args, QString *error) {
+    TRACE_SCOPE("qemu-img", args.join(' '));
+    QProcess proc;
+    proc.start(findQemuImgExecutable(), args);
+    if (!proc.waitForFinished(-1) || proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+        if (error) *error = QString::fromLocal8Bit(proc.readAllStandardError()).trimmed();
+        if (error && error->isEmpty()) *error = "qemu-img " + args.value(0) + " failed.";
+        return false;
+    }
+    return true;
+}
+
+// One incremental export of a VM's primary HDD into folder, driven by the event
+// loop: all QMP goes through one QmpClient and the backup job is polled from a
+// timer. A stopped VM's disk is opened by a device-less, paused helper QEMU for
+// the duration. Incremental copies only the clusters recorded in the bitmap
+// (which QEMU then clears); a full backup (re)creates the bitmap in the same
+// transaction so no write is missed.
+class IncrementalExport : public QObject {
+public:
+    // Called once, after the helper QEMU (if any) has exited.
+    typedef std::function<void(bool ok, const QString &error)> Callback;
+
+    // qmp is the running VM's endpoint, or empty to open the disk in a helper.
+    IncrementalExport(const VM &vm, const QString &folder, const QString &qmp, QObject *parent = nullptr)
+        : QObject(parent), m_vm(vm), m_dir(folder), m_qmp(qmp) {
+        m_poll.setInterval(500);
+        connect(&m_poll, &QTimer::timeout, this, [this] { pollJob(); });
+    }
+
+    bool isIncremental() const { return m_incremental; }
+    // Export images, full image first, including the new one.
+    QStringList chain() const { return m_chain; }
+    QString targetName() const { return m_targetName; }
+
+    void start(Callback done) {
+        TRACE_SCOPE("IncrementalExport::start", m_vm.name);
+        m_done = done;
+        if (m_qmp.isEmpty()) {
+            m_qmp = newQmpEndpoint();
+            if (m_qmp.isEmpty()) { finish(false, "Could not create a QMP socket."); return; }
+            m_helper = new QProcess(this);
+            m_helper->setProgram(findQemuExecutable());
+            m_helper->setArguments(QStringList() << "-M" << "none" << "-nodefaults" << "-display" << "none" << "-S"
+                                                 << "-qmp" << qmpChardevArg(m_qmp)
+                                                 << "-drive" << QString("file=%1,if=none,id=%2").arg(QString(m_vm.disk).replace(",", ",,"), primaryDriveId));
+            m_helper->setProcessChannelMode(QProcess::ForwardedChannels);
+            connect(m_helper, &QProcess::errorOccurred, this, [this](QProcess::ProcessError err) {
+                if (err != QProcess::FailedToStart) return;
+                finish(false, "Failed to start QEMU: " + m_helper->errorString());
+                report();
+            });
+            connect(m_helper, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this] {
+                finish(false, "QEMU exited during the export.");
+                report();
+            });
+            m_helper->start();
+            if (m_finishing) return;
+        }
+        m_client = new QmpClient(m_qmp, this);
+        m_client->execute("query-block", QJsonObject(), [this](const QJsonValue &result, const QString &error) {
+            if (!m_finishing) prepare(result, error);
+        });
+    }
+
+private:
+    // Picks full or incremental from the disk's bitmap and the folder's chain,
+    // creates the target image and attaches it as a block node.
+    void prepare(const QJsonValue &blocks, const QString &queryError) {
+        TRACE_SCOPE("IncrementalExport::prepare", m_vm.name);
+        QJsonObject disk;
+        for (const QJsonValue &dev : blocks.toArray()) {
+            if (dev.toObject().value("device").toString() == primaryDriveId) disk = dev.toObject();
+        }
+        if (disk.isEmpty()) {
+            finish(false, blocks.isUndefined() ? "Could not query the disk:\n" + queryError : "The VM has no primary HDD attached.");
+            return;
+        }
+        QJsonObject image = disk.value("inserted").toObject().value("image").toObject();
+        if (image.value("format").toString() != "qcow2") {
+            finish(false, "Incremental export needs a qcow2 disk image (persistent dirty bitmaps).");
+            return;
+        }
+        bool bitmapUsable = false;
+        for (const QJsonValue &b : disk.value("inserted").toObject().value("dirty-bitmaps").toArray()) {
+            QJsonObject bitmap = b.toObject();
+            if (bitmap.value("name").toString() != backupBitmapName) continue;
+            m_hasBitmap = true;
+            bitmapUsable = bitmap.value("persistent").toBool() && !bitmap.value("inconsistent").toBool();
+        }
+
+        // The bitmap only describes changes since the last export, so build on a
+        // chain only if that export is the newest image in this folder.
+        QSettings exportSettings(m_dir.filePath(m_vm.name + ".ini"), QSettings::IniFormat);
+        m_chain = exportSettings.value(m_vm.name + "/backup_chain").toStringList();
+        QSettings db(getDatabasePath(), QSettings::IniFormat);
+        QString lastBackup = db.value(m_vm.name + "/backup_last").toString();
+        m_incremental = bitmapUsable && !m_chain.isEmpty() && m_dir.filePath(m_chain.last()) == lastBackup;
+        for (const QString &link : m_chain) m_incremental = m_incremental && m_dir.exists(link);
+        if (!m_incremental) {
+            // A full backup resets the bitmap, so the old chain must not be built
+            // on if this one fails; the caller records the new chain on success.
+            m_chain.clear();
+            exportSettings.remove(m_vm.name + "/backup_chain");
+            exportSettings.sync();
+            db.remove(m_vm.name + "/backup_last");
+            db.sync();
+        }
+
+        QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+        m_targetName = QString("%1-%2-%3.qcow2").arg(QFileInfo(m_vm.disk).completeBaseName(), m_incremental ? "inc" : "full", stamp);
+        m_target = m_dir.filePath(m_targetName);
+        QStringList createArgs;
+        createArgs << "create" << "-f" << "qcow2";
+        if (m_incremental)
+            createArgs << "-b" << m_chain.last() << "-F" << "qcow2" << m_target; // relative to target's folder
+        else
+            createArgs << m_target << QString::number(static_cast<qint64>(image.value("virtual-size").toDouble()));
+        QString error;
+        if (!runQemuImg(createArgs, &error)) { finish(false, error); return; }
+        m_chain << m_targetName;
+
+        QJsonObject file;
+        file["driver"] = "file";
+        file["filename"] = m_target;
+        QJsonObject node;
+        node["driver"] = "qcow2";
+        node["node-name"] = backupTargetNode;
+        node["file"] = file;
+        m_client->execute("blockdev-add", node, [this](const QJsonValue &result, const QString &error) {
+            if (m_finishing) return;
+            if (result.isUndefined()) { finish(false, error); return; }
+            m_nodeAdded = true;
+            startJob();
+        });
+    }
+
+    void startJob() {
+        QJsonObject backup;
+        backup["job-id"] = backupJobId;
+        backup["device"] = primaryDriveId;
+        backup["target"] = backupTargetNode;
+        backup["auto-dismiss"] = false;
+        auto started = [this](const QJsonValue &result, const QString &error) {
+            if (m_finishing) return;
+            if (result.isUndefined()) { finish(false, error); return; }
+            m_poll.start();
+        };
+        if (m_incremental) {
+            backup["sync"] = "incremental";
+            backup["bitmap"] = backupBitmapName;
+            m_client->execute("blockdev-backup", backup, started);
+            return;
+        }
+
+        QJsonObject bitmap;
+        bitmap["node"] = primaryDriveId;
+        bitmap["name"] = backupBitmapName;
+        auto fullBackup = [this, backup, bitmap, started]() mutable {
+            bitmap["persistent"] = true;
+            backup["sync"] = "full";
+            QJsonArray actions;
+            actions.append(QJsonObject{{"type", "block-dirty-bitmap-add"}, {"data", bitmap}});
+            actions.append(QJsonObject{{"type", "blockdev-backup"}, {"data", backup}});
+            m_client->execute("transaction", QJsonObject{{"actions", actions}}, started);
+        };
+        if (!m_hasBitmap) { fullBackup(); return; }
+        m_client->execute("block-dirty-bitmap-remove", bitmap, [this, fullBackup](const QJsonValue &result, const QString &error) mutable {
+            if (m_finishing) return;
+            if (result.isUndefined()) { finish(false, error); return; }
+            fullBackup();
+        });
+    }
+
+    // Waits for the job (started with auto-dismiss off), then dismisses it.
+    void pollJob() {
+        if (m_polling) return; // previous query still outstanding
+        m_polling = true;
+        m_client->execute("query-jobs", QJsonObject(), [this](const QJsonValue &jobs, const QString &error) {
+            TRACE_SCOPE("IncrementalExport::pollJob", m_vm.name);
+            m_polling = false;
+            if (m_finishing) return;
+            if (jobs.isUndefined()) { finish(false, error); return; }
+            for (const QJsonValue &j : jobs.toArray()) {
+                QJsonObject job = j.toObject();
+                if (job.value("id").toString() != backupJobId) continue;
+                if (job.value("status").toString() != "concluded") return;
+                QString jobError = job.value("error").toString();
+                m_client->execute("job-dismiss", QJsonObject{{"id", backupJobId}}, [](const QJsonValue &, const QString &) {});
+                finish(jobError.isEmpty(), jobError);
+                return;
+            }
+            finish(false, QString("Backup job %1 disappeared.").arg(backupJobId));
+        });
+    }
+
+    // Detaches the target and stops the helper; report() follows once both are done.
+    void finish(bool ok, const QString &error) {
+        if (m_finishing) return;
+        m_finishing = true;
+        m_ok = ok;
+        m_error = error;
+        m_poll.stop();
+        const bool helperRunning = m_helper && m_helper->state() != QProcess::NotRunning;
+        if (m_nodeAdded) {
+            m_client->execute("blockdev-del", QJsonObject{{"node-name", backupTargetNode}},
+                              [this, helperRunning](const QJsonValue &, const QString &) { if (!helperRunning) report(); });
+        }
+        if (helperRunning) {
+            // Persistent bitmaps are written out on a clean exit.
+            if (m_client) m_client->execute("quit", QJsonObject(), [](const QJsonValue &, const QString &) {});
+            else m_helper->kill();
+            QTimer::singleShot(30000, this, [this] { if (m_helper->state() != QProcess::NotRunning) m_helper->kill(); });
+        } else if (!m_nodeAdded) {
+            report();
+        }
+    }
+
+    void report() {
+        if (m_reported) return;
+        m_reported = true;
+        if (!m_ok && !m_target.isEmpty()) QFile::remove(m_target);
+        // Deferred so the callback never runs inside a QmpClient or QProcess signal.
+        QTimer::singleShot(0, this, [this] { m_done(m_ok, m_error); });
+    }
+
+    VM m_vm;
+    QDir m_dir;
+    QString m_qmp;
+    QProcess *m_helper = nullptr;
+    QmpClient *m_client = nullptr;
+    QTimer m_poll;
+    Callback m_done;
+    bool m_hasBitmap = false;
+    bool m_incremental = false;
+    bool m_nodeAdded = false;
+    bool m_polling = false;
+    bool m_finishing = false;
+    bool m_reported = false;
+    bool m_ok = false;
+    QString m_error;
+    QStringList m_chain;
+    QString m_targetName;
+    QString m_target;
+};
+
 class VMDialog : public QDialog {
     Q_OBJECT
 public:
@@ -167,9 +1079,33 @@ public:
         customArgsEdit = new QTextEdit(this); // Custom Arguments
         customArgsEdit->setPlaceholderText("e.g. -s -device intel-hda");
 
+        throttleCheck = new QCheckBox(this);
+        throttleBpsSpin = new QSpinBox(this); throttleBpsSpin->setRange(0, 100000); throttleBpsSpin->setSpecialValueText("unlimited");
+        throttleIopsSpin = new QSpinBox(this); throttleIopsSpin->setRange(0, 1000000); throttleIopsSpin->setSpecialValueText("unlimited");
+        throttleBpsMaxSpin = new QSpinBox(this); throttleBpsMaxSpin->setRange(0, 100000); throttleBpsMaxSpin->setSpecialValueText("no burst");
+        throttleIopsMaxSpin = new QSpinBox(this); throttleIopsMaxSpin->setRange(0, 1000000); throttleIopsMaxSpin->setSpecialValueText("no burst");
+        throttleBurstLenSpin = new QSpinBox(this); throttleBurstLenSpin->setRange(1, 3600); throttleBurstLenSpin->setValue(1);
+
+        poolSizeSpin = new QSpinBox(this); poolSizeSpin->setRange(0, 64); poolSizeSpin->setSpecialValueText("off");
+        poolMemSpin = new QSpinBox(this); poolMemSpin->setRange(0, 1048576); poolMemSpin->setSpecialValueText("no limit");
+        poolBootSpin = new QSpinBox(this); poolBootSpin->setRange(0, 600); poolBootSpin->setSpecialValueText("paused before boot");
+
+        profileCombo = new QComboBox(this);
+        profileCombo->addItem("desktop");
+        profileCombo->addItem("server");
+        profileCombo->addItem("microvm");
+        profileCombo->setToolTip("desktop: boot menu, VGA, USB tablet, SDL window\n"
+                                 "server: q35 with virtio devices, no boot menu, USB or audio, headless unless VNC is on\n"
+                                 "microvm: minimal virtio-mmio machine, needs a kernel, no display, CD-ROM or audio");
+        kernelEdit = new QLineEdit(this);
+        initrdEdit = new QLineEdit(this);
+        appendEdit = new QLineEdit(this);
+        appendEdit->setPlaceholderText("e.g. root=/dev/vda1 console=ttyS0");
 
         QPushButton *browseDisk = new QPushButton("Browse...", this);
         QPushButton *browseIso = new QPushButton("Browse...", this);
+        QPushButton *browseKernel = new QPushButton("Browse...", this);
+        QPushButton *browseInitrd = new QPushButton("Browse...", this);
 
         connect(browseDisk, &QPushButton::clicked, this, [this](){
             QString f = QFileDialog::getOpenFileName(this, "Select Disk Image", QDir::homePath(),
@@ -181,12 +1117,26 @@ public:
                                                      "ISOs (*.iso);;All Files (*)");
             if (!f.isEmpty()) isoEdit->setText(f);
         });
+        connect(browseKernel, &QPushButton::clicked, this, [this](){
+            QString f = QFileDialog::getOpenFileName(this, "Select Kernel Image", QDir::homePath(), "All Files (*)");
+            if (!f.isEmpty()) kernelEdit->setText(f);
+        });
+        connect(browseInitrd, &QPushButton::clicked, this, [this](){
+            QString f = QFileDialog::getOpenFileName(this, "Select Initrd", QDir::homePath(), "All Files (*)");
+            if (!f.isEmpty()) initrdEdit->setText(f);
+        });
 
         form->addRow("VM Name:", nameEdit);
         QHBoxLayout *h1 = new QHBoxLayout; h1->addWidget(diskEdit); h1->addWidget(browseDisk);
         form->addRow("Disk Image:", h1);
         QHBoxLayout *h2 = new QHBoxLayout; h2->addWidget(isoEdit); h2->addWidget(browseIso);
         form->addRow("ISO Image (optional):", h2);
+        form->addRow("Launch Profile:", profileCombo);
+        QHBoxLayout *h3 = new QHBoxLayout; h3->addWidget(kernelEdit); h3->addWidget(browseKernel);
+        form->addRow("Kernel (optional):", h3);
+        QHBoxLayout *h4 = new QHBoxLayout; h4->addWidget(initrdEdit); h4->addWidget(browseInitrd);
+        form->addRow("Initrd (optional):", h4);
+        form->addRow("Kernel Command Line:", appendEdit);
         form->addRow("Memory (MB):", memSpin);
         form->addRow("CPU type:", cpuEdit);
         form->addRow("Network Enabled:", netCheck);
@@ -198,6 +1148,15 @@ public:
         form->addRow("Override Accelerator:", accelOverrideCheck);
         form->addRow("Accelerator Type:", accelTypeCombo);
         form->addRow("Custom QEMU Arguments:", customArgsEdit); // NEW
+        form->addRow("Throttle Disk I/O:", throttleCheck);
+        form->addRow("Disk Limit (MB/s):", throttleBpsSpin);
+        form->addRow("Disk Limit (IOPS):", throttleIopsSpin);
+        form->addRow("Burst Limit (MB/s):", throttleBpsMaxSpin);
+        form->addRow("Burst Limit (IOPS):", throttleIopsMaxSpin);
+        form->addRow("Burst Length (s):", throttleBurstLenSpin);
+        form->addRow("Pool Size (pre-launched):", poolSizeSpin);
+        form->addRow("Pool Memory Limit (MB):", poolMemSpin);
+        form->addRow("Pool Boot Before Pause (s):", poolBootSpin);
 
         QPushButton *ok = new QPushButton("Save", this);
         QPushButton *cancel = new QPushButton("Cancel", this);
@@ -224,6 +1183,19 @@ public:
         accelOverrideCheck->setChecked(vm.accel_override);
         accelTypeCombo->setCurrentText(vm.accel_type);
         customArgsEdit->setText(vm.custom_args); // NEW
+        throttleCheck->setChecked(vm.throttle);
+        throttleBpsSpin->setValue(vm.throttle_bps);
+        throttleIopsSpin->setValue(vm.throttle_iops);
+        throttleBpsMaxSpin->setValue(vm.throttle_bps_max);
+        throttleIopsMaxSpin->setValue(vm.throttle_iops_max);
+        throttleBurstLenSpin->setValue(vm.throttle_burst_len);
+        poolSizeSpin->setValue(vm.pool_size);
+        poolMemSpin->setValue(vm.pool_mem_limit);
+        poolBootSpin->setValue(vm.pool_boot_secs);
+        profileCombo->setCurrentText(vm.profile);
+        kernelEdit->setText(vm.kernel);
+        initrdEdit->setText(vm.initrd);
+        appendEdit->setText(vm.kernel_append);
     }
 
     VM getVM() const {
@@ -242,6 +1214,19 @@ public:
         vm.accel_override = accelOverrideCheck->isChecked();
         vm.accel_type = accelTypeCombo->currentText();
         vm.custom_args = customArgsEdit->toPlainText().trimmed(); // NEW
+        vm.throttle = throttleCheck->isChecked();
+        vm.throttle_bps = throttleBpsSpin->value();
+        vm.throttle_iops = throttleIopsSpin->value();
+        vm.throttle_bps_max = throttleBpsMaxSpin->value();
+        vm.throttle_iops_max = throttleIopsMaxSpin->value();
+        vm.throttle_burst_len = throttleBurstLenSpin->value();
+        vm.pool_size = poolSizeSpin->value();
+        vm.pool_mem_limit = poolMemSpin->value();
+        vm.pool_boot_secs = poolBootSpin->value();
+        vm.profile = profileCombo->currentText();
+        vm.kernel = kernelEdit->text().trimmed();
+        vm.initrd = initrdEdit->text().trimmed();
+        vm.kernel_append = appendEdit->text().trimmed();
         return vm;
     }
 
@@ -249,6 +1234,35 @@ private slots:
     void onSave() {
         if (nameEdit->text().trimmed().isEmpty()) { QMessageBox::warning(this, "Validation", "VM name is required."); return; }
         if (diskEdit->text().trimmed().isEmpty() && hdaCheck->isChecked()) { QMessageBox::warning(this, "Validation", "Disk image required for primary HDD."); return; }
+        if (throttleCheck->isChecked()) {
+            // QEMU only allows a burst on top of a sustained limit.
+            if ((throttleBpsMaxSpin->value() > 0 && throttleBpsSpin->value() == 0)
+                || (throttleIopsMaxSpin->value() > 0 && throttleIopsSpin->value() == 0)) {
+                QMessageBox::warning(this, "Validation", "A burst limit needs a sustained limit of the same kind; an unlimited rate cannot have a burst."); return;
+            }
+            if ((throttleBpsMaxSpin->value() > 0 && throttleBpsMaxSpin->value() < throttleBpsSpin->value())
+                || (throttleIopsMaxSpin->value() > 0 && throttleIopsMaxSpin->value() < throttleIopsSpin->value())) {
+                QMessageBox::warning(this, "Validation", "Burst limits cannot be lower than the sustained limits."); return;
+            }
+        }
+        if (poolSizeSpin->value() > 0 && (!hdaCheck->isChecked() || diskEdit->text().trimmed().isEmpty())) {
+            QMessageBox::warning(this, "Validation", "A VM pool needs a primary HDD image to overlay."); return;
+        }
+        if (poolSizeSpin->value() > 0 && poolMemSpin->value() > 0 && poolMemSpin->value() < memSpin->value()) {
+            QMessageBox::warning(this, "Validation", "The pool memory limit is below the memory of one VM, so the pool would stay empty."); return;
+        }
+        if (!initrdEdit->text().trimmed().isEmpty() && kernelEdit->text().trimmed().isEmpty()) {
+            QMessageBox::warning(this, "Validation", "An initrd needs a kernel."); return;
+        }
+        if (profileCombo->currentText() == "microvm") {
+            if (kernelEdit->text().trimmed().isEmpty()) { QMessageBox::warning(this, "Validation", "The microvm profile boots a kernel directly; set a kernel image."); return; }
+            if (!isoEdit->text().trimmed().isEmpty() || vncCheck->isChecked() || audioCheck->isChecked()) {
+                QMessageBox::warning(this, "Validation", "The microvm profile has no CD-ROM, display or audio. Clear the ISO, VNC and audio options."); return;
+            }
+        }
+        if (profileCombo->currentText() == "server" && audioCheck->isChecked()) {
+            QMessageBox::warning(this, "Validation", "The server profile has no audio device. Clear the audio option or use the desktop profile."); return;
+        }
         accept();
     }
 
@@ -259,6 +1273,11 @@ private:
     QCheckBox *accelOverrideCheck;
     QComboBox *accelTypeCombo;
     QTextEdit *customArgsEdit; // NEW
+    QCheckBox *throttleCheck;
+    QSpinBox *throttleBpsSpin, *throttleIopsSpin, *throttleBpsMaxSpin, *throttleIopsMaxSpin, *throttleBurstLenSpin;
+    QSpinBox *poolSizeSpin, *poolMemSpin, *poolBootSpin;
+    QComboBox *profileCombo;
+    QLineEdit *kernelEdit, *initrdEdit, *appendEdit;
 };
 
 class DeleteConfirmDialog : public QDialog {
@@ -307,6 +1326,277 @@ private:
 };
 
 
+// Keeps pre-launched, paused instances of a template VM so one can be handed
+// out with a single QMP "cont". Each instance runs on its own qcow2 overlay of
+// the template disk and is launched with buildQemuArgs like any other VM.
+// Taken instances are replaced in the background.
+class VMPool : public QObject {
+public:
+    struct Instance {
+        QString name;
+        QString overlay;
+        QProcess *proc = nullptr;
+        QString qmpSocket;
+        QmpClient *qmp = nullptr; // open while the instance is prepared; closed by take()
+        VM launchedAs;            // template settings the instance was started with
+        int vncPort = 0;          // own VNC port when the template uses VNC
+        bool ready = false;
+    };
+
+    VMPool(const VM &templ, QObject *parent = nullptr) : QObject(parent), m_template(templ) {
+        m_backingFormat = probeDiskFormat(templ.disk);
+        refill();
+    }
+
+    ~VMPool() override {
+        QList<Instance> instances;
+        instances.swap(m_instances); // pending QMP callbacks then find nothing to update
+        for (const Instance &inst : instances) discard(inst);
+    }
+
+    const VM &templ() const { return m_template; }
+
+    // Last reason an instance was dropped, for the user; empty if none failed.
+    QString lastError() const { return m_lastError; }
+
+    // Adopts settings that do not change how instances are launched, such as
+    // throttle limits or the pool size. take() hands out instances as they were
+    // started, so the caller applies a changed throttle itself.
+    void setTemplate(const VM &templ) {
+        m_template = templ;
+        while (m_instances.size() > targetSize()) {
+            QString surplus = m_instances.last().name;
+            drop(surplus);
+        }
+        refill();
+    }
+
+    int targetSize() const {
+        int size = m_template.pool_size;
+        if (m_template.pool_mem_limit > 0) size = qMin(size, m_template.pool_mem_limit / qMax(1, m_template.mem));
+        return qMax(0, size);
+    }
+
+    int readyCount() const {
+        int n = 0;
+        for (const Instance &inst : m_instances) if (inst.ready) ++n;
+        return n;
+    }
+
+    // Hands a ready instance to the caller, who then owns its process and overlay.
+    bool take(Instance *out) {
+        QStringList registered = vmNames();
+        bool found = false;
+        for (int i = 0; i < m_instances.size() && !found; ++i) {
+            if (!m_instances[i].ready) continue;
+            // A VM created or renamed since the spawn may have claimed the name.
+            if (registered.contains(m_instances[i].name)) {
+                QString stale = m_instances[i].name;
+                drop(stale);
+                --i;
+                continue;
+            }
+            *out = m_instances.takeAt(i);
+            out->proc->disconnect(this);
+            delete out->qmp; // frees the monitor for the caller
+            out->qmp = nullptr;
+            reservedVncPorts().remove(out->vncPort); // the caller registers it with the VM
+            found = true;
+        }
+        QTimer::singleShot(0, this, [this] { refill(); });
+        return found;
+    }
+
+    void refill() {
+        while (m_instances.size() < targetSize()) spawn();
+    }
+
+private:
+    static QString probeDiskFormat(const QString &disk) {
+        TRACE_SCOPE("qemu-img info", disk);
+        QProcess proc;
+        proc.start(findQemuImgExecutable(), QStringList() << "info" << "--output=json" << disk);
+        if (proc.waitForFinished() && proc.exitCode() == 0) {
+            QString fmt = QJsonDocument::fromJson(proc.readAllStandardOutput()).object().value("format").toString();
+            if (!fmt.isEmpty()) return fmt;
+        }
+        return QFileInfo(disk).suffix() == "qcow2" ? "qcow2" : "raw";
+    }
+
+    static QString poolDir() {
+        QString dir = QDir(QCoreApplication::applicationDirPath()).filePath("pool");
+        QDir().mkpath(dir);
+        return dir;
+    }
+
+    int indexOf(const QString &name) const {
+        for (int i = 0; i < m_instances.size(); ++i) if (m_instances[i].name == name) return i;
+        return -1;
+    }
+
+    QString nextInstanceName() const {
+        QStringList taken = vmNames();
+        for (int n = 1;; ++n) {
+            QString candidate = QString("%1-%2").arg(m_template.name).arg(n);
+            // A taken instance keeps its overlay when renamed, so check the file too.
+            if (!taken.contains(candidate) && indexOf(candidate) < 0
+                && !QFileInfo::exists(QDir(poolDir()).filePath(candidate + ".qcow2")))
+                return candidate;
+        }
+    }
+
+    void spawn() {
+        Instance inst;
+        inst.name = nextInstanceName();
+        inst.overlay = QDir(poolDir()).filePath(inst.name + ".qcow2");
+        m_instances.append(inst);
+
+        const QString name = inst.name;
+        QProcess *img = new QProcess(this);
+        img->setProgram(findQemuImgExecutable());
+        img->setArguments(QStringList() << "create" << "-f" << "qcow2" << "-b" << m_template.disk
+                                        << "-F" << m_backingFormat << inst.overlay);
+        connect(img, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, img, name](int exitCode, QProcess::ExitStatus status) {
+            img->deleteLater();
+            if (status != QProcess::NormalExit || exitCode != 0) {
+                QString detail = QString::fromLocal8Bit(img->readAllStandardError()).trimmed();
+                fail(name, QString("qemu-img could not create the overlay for %1.\n%2").arg(name, detail));
+                return;
+            }
+            launch(name);
+        });
+        connect(img, &QProcess::errorOccurred, this, [this, img, name](QProcess::ProcessError err) {
+            if (err != QProcess::FailedToStart) return;
+            img->deleteLater();
+            fail(name, "Failed to start qemu-img: " + img->errorString());
+        });
+        img->start();
+    }
+
+    void launch(const QString &name) {
+        int i = indexOf(name);
+        if (i < 0) return;
+        Instance &inst = m_instances[i];
+
+        VM vm = m_template;
+        vm.name = inst.name;
+        vm.disk = inst.overlay;
+        if (vm.vnc) {
+            // Instances run side by side, so each needs its own display.
+            inst.vncPort = freeVncPort();
+            if (!inst.vncPort) { fail(name, "No free VNC port (5900-5999) for " + name + "."); return; }
+            vm.vnc_port = inst.vncPort;
+        }
+        inst.qmpSocket = newQmpEndpoint();
+        if (inst.qmpSocket.isEmpty()) { fail(name, "Could not create a QMP socket for " + name + "."); return; }
+        inst.launchedAs = m_template;
+
+        QStringList args = buildQemuArgs(vm, inst.qmpSocket);
+        if (m_template.pool_boot_secs <= 0) args << "-S";
+
+        inst.proc = new QProcess(this);
+        inst.proc->setProgram(findQemuExecutable());
+        inst.proc->setArguments(args);
+        inst.proc->setProcessChannelMode(QProcess::ForwardedChannels);
+        connect(inst.proc, &QProcess::started, this, [this, name] {
+            int i = indexOf(name);
+            if (i < 0) return;
+            m_instances[i].qmp = new QmpClient(m_instances[i].qmpSocket, this);
+            if (m_template.pool_boot_secs > 0)
+                QTimer::singleShot(m_template.pool_boot_secs * 1000, this, [this, name] { markReady(name); });
+            else
+                markReady(name);
+        });
+        connect(inst.proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, name](int exitCode) {
+            fail(name, QString("Pooled instance %1 exited with code %2.").arg(name).arg(exitCode));
+        });
+        connect(inst.proc, &QProcess::errorOccurred, this, [this, name](QProcess::ProcessError err) {
+            if (err == QProcess::FailedToStart) fail(name, "Failed to start QEMU for " + name + ".");
+        });
+        inst.proc->start();
+    }
+
+    // Queues the QMP setup; the instance is ready once the last command answers.
+    // "stop" pauses a booted guest; a guest held at -S only needs a live monitor.
+    void markReady(const QString &name) {
+        TRACE_SCOPE("VMPool::markReady", name);
+        int i = indexOf(name);
+        if (i < 0) return;
+        QmpClient *qmp = m_instances[i].qmp;
+        enableLatencyHistogram(qmp, m_instances[i].launchedAs, [](const QJsonValue &, const QString &) {});
+        const bool booted = m_template.pool_boot_secs > 0;
+        qmp->execute(booted ? "stop" : "query-status", QJsonObject(),
+                     [this, name, booted](const QJsonValue &result, const QString &error) {
+            int i = indexOf(name);
+            if (i < 0) return;
+            if (result.isUndefined()) {
+                fail(name, QString("Could not %1 pooled instance %2:\n%3").arg(booted ? "pause" : "reach", name, error));
+                return;
+            }
+            m_instances[i].ready = true;
+        });
+    }
+
+    void fail(const QString &name, const QString &error) {
+        if (indexOf(name) < 0) return;
+        m_lastError = error;
+        drop(name);
+    }
+
+    // Removes a failed or exited instance. It is not respawned until the next
+    // take() or reconfiguration, so a broken template cannot spin in a loop.
+    void drop(const QString &name) {
+        int i = indexOf(name);
+        if (i < 0) return;
+        discard(m_instances.takeAt(i));
+    }
+
+    // VNC ports held by pooled instances of every pool; QEMU may not have bound them yet.
+    static QSet<int> &reservedVncPorts() {
+        static QSet<int> ports;
+        return ports;
+    }
+
+    // A port in the VNC dialog's range that no pooled instance or registered VM
+    // uses and that nothing is listening on; 0 if none is left.
+    static int freeVncPort() {
+        QSet<int> used = reservedVncPorts();
+        for (const QString &vmName : vmNames()) {
+            VM other = vmFromSettings(vmName);
+            if (other.vnc) used.insert(other.vnc_port);
+        }
+        for (int port = 5900; port <= 5999; ++port) {
+            if (used.contains(port)) continue;
+            QTcpServer probe;
+            if (!probe.listen(QHostAddress::Any, port)) continue;
+            probe.close();
+            reservedVncPorts().insert(port);
+            return port;
+        }
+        return 0;
+    }
+
+    void discard(const Instance &inst) {
+        reservedVncPorts().remove(inst.vncPort);
+        if (inst.qmp) inst.qmp->deleteLater();
+        if (inst.proc) {
+            inst.proc->disconnect(this);
+            if (inst.proc->state() != QProcess::NotRunning) {
+                inst.proc->kill();
+                inst.proc->waitForFinished(5000);
+            }
+            inst.proc->deleteLater();
+        }
+        QFile::remove(inst.overlay);
+    }
+
+    VM m_template;
+    QString m_backingFormat;
+    QList<Instance> m_instances;
+    QString m_lastError;
+};
+
 class MainWindow : public QWidget {
     Q_OBJECT
 public:
@@ -323,14 +1613,18 @@ public:
         deleteBtn = new QPushButton("Delete VM", this);
         createDiskBtn = new QPushButton("Create Disk", this);
         exportBtn = new QPushButton("Export", this);
+        incExportBtn = new QPushButton("Incremental Export", this);
         importBtn = new QPushButton("Import", this);
+        diskStatsBtn = new QPushButton("Disk Stats", this);
+        takePoolBtn = new QPushButton("Take From Pool", this);
+        traceBtn = new QPushButton(Trace::isEnabled() ? "Stop Trace" : "Start Trace", this);
         quitBtn = new QPushButton("Quit", this);
 
         QHBoxLayout *btns = new QHBoxLayout;
         btns->addWidget(createBtn); btns->addWidget(editBtn); btns->addWidget(renameBtn);
-        btns->addWidget(deleteBtn); btns->addWidget(launchBtn); btns->addWidget(killBtn);
-        btns->addWidget(createDiskBtn); btns->addWidget(exportBtn);
-        btns->addWidget(importBtn); btns->addStretch(); btns->addWidget(quitBtn);
+        btns->addWidget(deleteBtn); btns->addWidget(launchBtn); btns->addWidget(takePoolBtn); btns->addWidget(killBtn);
+        btns->addWidget(createDiskBtn); btns->addWidget(exportBtn); btns->addWidget(incExportBtn);
+        btns->addWidget(importBtn); btns->addWidget(diskStatsBtn); btns->addWidget(traceBtn); btns->addStretch(); btns->addWidget(quitBtn);
 
         QVBoxLayout *main = new QVBoxLayout(this);
         main->addWidget(listWidget);
@@ -344,29 +1638,36 @@ public:
         connect(killBtn, &QPushButton::clicked, this, &MainWindow::onKill);
         connect(createDiskBtn, &QPushButton::clicked, this, &MainWindow::onCreateDisk);
         connect(exportBtn, &QPushButton::clicked, this, &MainWindow::onExport);
+        connect(incExportBtn, &QPushButton::clicked, this, &MainWindow::onIncrementalExport);
         connect(importBtn, &QPushButton::clicked, this, &MainWindow::onImport);
+        connect(diskStatsBtn, &QPushButton::clicked, this, &MainWindow::onDiskStats);
+        connect(takePoolBtn, &QPushButton::clicked, this, &MainWindow::onTakeFromPool);
+        connect(traceBtn, &QPushButton::clicked, this, &MainWindow::onToggleTrace);
         connect(quitBtn, &QPushButton::clicked, &QWidget::close);
 
         loadList();
+        for (const QString &vmName : vmNames()) syncPool(vmName, vmFromSettings(vmName));
     }
 
 private slots:
     void loadList() {
+        TRACE_SCOPE("loadList");
         listWidget->clear();
-        QSettings s(getDatabasePath(), QSettings::IniFormat);
-        for (const QString &group : s.childGroups()) listWidget->addItem(group);
+        for (const QString &group : vmNames()) listWidget->addItem(group);
     }
 
     void onCreate() {
         VMDialog dlg(this);
         if (dlg.exec() == QDialog::Accepted) {
+            TraceSpan span("onCreate");
             VM vm = dlg.getVM();
-            QSettings s(getDatabasePath(), QSettings::IniFormat);
-            if (s.childGroups().contains(vm.name)) {
+            if (vmNames().contains(vm.name)) {
+                span.end();
                 QMessageBox::warning(this, "Error", "A VM with this name already exists. Creation aborted.");
                 return;
             }
             vmToSettings(vm);
+            syncPool(vm.name, vm);
             loadList();
         }
     }
@@ -375,14 +1676,17 @@ private slots:
         auto item = listWidget->currentItem();
         if (!item) return;
         QString name = item->text();
+        if (exportBusy(name, "Edit VM")) return;
         VM vm = vmFromSettings(name);
         VMDialog dlg(this);
         dlg.setVM(vm);
         if (dlg.exec() == QDialog::Accepted) {
+            TraceSpan span("onEdit");
             VM newvm = dlg.getVM();
+            if (newvm.disk == vm.disk) newvm.backing_disk = vm.backing_disk;
             if (newvm.name != name) {
-                QSettings s_check(getDatabasePath(), QSettings::IniFormat);
-                if (s_check.childGroups().contains(newvm.name)) {
+                if (vmNames().contains(newvm.name)) {
+                    span.end();
                     QMessageBox::warning(this, "Error", "A VM with the new name already exists. Save aborted.");
                     return;
                 }
@@ -396,9 +1700,23 @@ private slots:
                     runningProcs.remove(name);
                     runningProcs[newvm.name] = proc;
                 }
+                if (qmpSockets.contains(name)) qmpSockets[newvm.name] = qmpSockets.take(name);
             }
             vmToSettings(newvm);
+            if (pools.contains(name) && newvm.pool_size > 0 && samePoolLaunch(vm, newvm))
+                pools.value(name)->setTemplate(newvm);
+            else
+                syncPool(name, newvm);
             loadList();
+
+            // Throttle limits take effect immediately on a running VM.
+            if (!sameThrottle(vm, newvm) && newvm.hda && isRunning(newvm.name) && qmpSockets.contains(newvm.name)) {
+                QString error;
+                bool applied = applyIoThrottle(qmpSockets.value(newvm.name), newvm, &error);
+                span.end();
+                if (!applied)
+                    QMessageBox::warning(this, "I/O Throttle", "Settings saved, but the running VM could not be updated:\n" + error);
+            }
         }
     }
 
@@ -406,6 +1724,7 @@ private slots:
         auto item = listWidget->currentItem();
         if (!item) return;
         QString oldName = item->text();
+        if (exportBusy(oldName, "Rename VM")) return;
 
         bool ok;
         QString newName = QInputDialog::getText(this, "Rename VM",
@@ -413,8 +1732,10 @@ private slots:
                                                 QLineEdit::Normal, oldName, &ok);
 
         if (ok && !newName.trimmed().isEmpty() && newName != oldName) {
+            TraceSpan span("onRename");
             QSettings s(getDatabasePath(), QSettings::IniFormat);
-            if (s.childGroups().contains(newName)) {
+            if (vmNames().contains(newName)) {
+                span.end();
                 QMessageBox::warning(this, "Error", "A VM with this name already exists.");
                 return;
             }
@@ -430,8 +1751,11 @@ private slots:
                 runningProcs.remove(oldName);
                 runningProcs[newName] = proc;
             }
+            if (qmpSockets.contains(oldName)) qmpSockets[newName] = qmpSockets.take(oldName);
+            syncPool(oldName, vm);
 
             loadList();
+            span.end();
             QMessageBox::information(this, "Rename Success", QString("VM successfully renamed to '%1'").arg(newName));
         }
     }
@@ -440,11 +1764,20 @@ private slots:
         auto item = listWidget->currentItem();
         if (!item) return;
         QString name = item->text();
+        if (exportBusy(name, "Delete")) return;
 
         VM vm = vmFromSettings(name);
         
         DeleteConfirmDialog confirmDlg(vm, this);
         if (confirmDlg.exec() == QDialog::Rejected) return;
+        QStringList overlays = overlayUsers(vm.disk);
+        if (confirmDlg.shouldDeleteDisk() && !overlays.isEmpty()) {
+            QMessageBox::warning(this, "Delete", QString("The disk image backs VMs taken from this VM's pool (%1).\n"
+                                                         "Delete those VMs first, or keep the disk image.")
+                                                     .arg(overlays.join(", ")));
+            return;
+        }
+        TraceSpan span("onDelete");
 
         if (runningProcs.contains(name)) {
             QProcess *proc = runningProcs[name];
@@ -454,15 +1787,19 @@ private slots:
             }
             runningProcs.remove(name);
         }
+        qmpSockets.remove(name);
+        // Pooled overlays are backed by this VM's disk, so they must go first.
+        stopPool(name);
 
         bool fileCleanupSuccess = true;
         QString deletedFiles = "";
+        QString failedFiles;
         
         if (confirmDlg.shouldDeleteDisk() && !vm.disk.isEmpty() && QFileInfo::exists(vm.disk)) {
             if (QFile::remove(vm.disk)) {
                 deletedFiles += QFileInfo(vm.disk).fileName() + " (Disk Image)\n";
             } else {
-                QMessageBox::warning(this, "Cleanup Error", QString("Failed to delete disk image:\n%1").arg(vm.disk));
+                failedFiles += vm.disk + " (Disk Image)\n";
                 fileCleanupSuccess = false;
             }
         }
@@ -471,7 +1808,7 @@ private slots:
             if (QFile::remove(vm.iso)) {
                 deletedFiles += QFileInfo(vm.iso).fileName() + " (ISO File)\n";
             } else {
-                QMessageBox::warning(this, "Cleanup Error", QString("Failed to delete ISO image:\n%1").arg(vm.iso));
+                failedFiles += vm.iso + " (ISO File)\n";
                 fileCleanupSuccess = false;
             }
         }
@@ -481,6 +1818,7 @@ private slots:
         s.sync();
 
         loadList();
+        span.end();
         
         QString statusMessage = QString("VM '<b>%1</b>' configuration has been deleted.").arg(name);
         if (!deletedFiles.isEmpty()) {
@@ -490,7 +1828,7 @@ private slots:
         if (fileCleanupSuccess) {
             QMessageBox::information(this, "Deleted", statusMessage);
         } else {
-            QMessageBox::warning(this, "Deleted (Partial Cleanup)", statusMessage + "\n\nOne or more selected files could not be deleted.");
+            QMessageBox::warning(this, "Deleted (Partial Cleanup)", statusMessage + "\n\nThe following files could not be deleted:\n" + failedFiles);
         }
     }
 
@@ -499,85 +1837,33 @@ private slots:
         auto item = listWidget->currentItem();
         if (!item) return;
         QString name = item->text();
+        if (exportBusy(name, "Launch")) return;
+        TraceSpan span("onLaunch");
         VM vm = vmFromSettings(name);
 
         if (vm.hda && vm.disk.isEmpty()) {
+            span.end();
             QMessageBox::warning(this, "Launch", "Primary HDD is enabled but no disk image is set.");
             return;
         }
-
-        QString qemu = findQemuExecutable();
-        QStringList args;
-
-        QString accelArg;
-        if (vm.accel_override && vm.accel_type != "default") {
-            accelArg = vm.accel_type;
-        } else {
-#ifdef Q_OS_WIN
-            accelArg = hasVirtualization() ? "whpx" : "tcg";
-#else
-            accelArg = hasVirtualization() ? "kvm" : "tcg";
-#endif
-        }
-        
-#ifdef Q_OS_WIN
-        if (accelArg == "kvm") {
-            accelArg = hasVirtualization() ? "whpx" : "tcg";
-        }
-#else
-        if (accelArg == "whpx" || accelArg == "hax") {
-            accelArg = hasVirtualization() ? "kvm" : "tcg";
-        }
-#endif
-        
-        args << "-accel" << accelArg;
-
-
-        args << "-m" << QString::number(vm.mem);
-        if (!vm.cpu.trimmed().isEmpty())
-            args << "-cpu" << vm.cpu;
-
-        if (vm.hda) args << "-hda" << vm.disk;
-        if (!vm.iso.isEmpty()) args << "-cdrom" << vm.iso;
-
-        args << "-boot" << "menu=on";
-        args << "-vga" << "std";
-        args << "-usb" << "-device" << "usb-tablet";
-        args << "-name" << vm.name;
-
-        if (vm.net) args << "-net" << "nic" << "-net" << "user";
-
-        if (vm.audio) {
-#ifdef Q_OS_WIN
-            args << "-audiodev" << "dsound,id=snd0"
-                 << "-device" << "ich9-intel-hda"
-                 << "-device" << "hda-output,audiodev=snd0";
-#else
-            args << "-audiodev" << "pa,id=snd0"
-                 << "-device" << "ich9-intel-hda"
-                 << "-device" << "hda-output,audiodev=snd0";
-#endif
-        }
-
-        if (vm.vnc) {
-            QString vncArg = QString(":%1").arg(vm.vnc_port - 5900);
-            if (vm.vnc_pass) vncArg += ",password=on";
-            args << "-vnc" << vncArg;
-        }
-
-        // Default display and monitor setup (moved from the VNC block)
-        if (!vm.vnc) {
-             args << "-display" << "sdl";
+        if (pools.contains(name)) {
+            span.end();
+            QMessageBox::warning(this, "Launch", "This VM is a pool template and its disk is the read-only backing image of the pool.\n"
+                                                 "Use \"Take From Pool\", or set its pool size to 0 to launch it directly.");
+            return;
         }
-        args << "-monitor" << "stdio";
-
-        // FIX: Replaced deprecated QString::split(QRegExp, SplitBehavior) with modern QString::split(QRegularExpression, Qt::SplitBehavior)
-        if (!vm.custom_args.isEmpty()) {
-            QRegularExpression rx("\\s+"); // Matches one or more whitespace characters
-            QStringList customArgs = vm.custom_args.split(rx, Qt::SkipEmptyParts);
-            args << customArgs;
+        QStringList overlays = overlayUsers(vm.disk);
+        if (!overlays.isEmpty()) {
+            span.end();
+            QMessageBox::warning(this, "Launch", QString("This VM's disk is the backing image of VMs taken from its pool (%1).\n"
+                                                         "Writing to it would corrupt them, so it cannot be launched while they exist.")
+                                                     .arg(overlays.join(", ")));
+            return;
         }
 
+        QString qemu = findQemuExecutable();
+        QString qmp = newQmpEndpoint();
+        QStringList args = buildQemuArgs(vm, qmp);
 
         QProcess *proc = new QProcess(this);
         proc->setProgram(qemu);
@@ -585,16 +1871,28 @@ private slots:
         proc->setProcessChannelMode(QProcess::ForwardedChannels);
         proc->start();
 
-        if (!proc->waitForStarted()) {
+        bool started;
+        {
+            TRACE_SCOPE("QProcess::waitForStarted", qemu);
+            started = proc->waitForStarted();
+        }
+        if (!started) {
+            span.end();
             QMessageBox::critical(this, "Error", QString("Failed to start QEMU: %1").arg(proc->errorString()));
             proc->deleteLater();
             return;
         }
 
         runningProcs[name] = proc;
+        if (qmp.isEmpty()) return;
+        qmpSockets[name] = qmp;
+        if (!vm.hda) return;
+        QmpClient *client = new QmpClient(qmp, this);
+        enableLatencyHistogram(client, vm, [client](const QJsonValue &, const QString &) { client->deleteLater(); });
     }
 
     void onKill() {
+        TraceSpan span("onKill");
         auto item = listWidget->currentItem();
         if (!item) return;
         QString name = item->text();
@@ -603,10 +1901,13 @@ private slots:
             if (proc->state() != QProcess::NotRunning) {
                 proc->kill();
                 proc->waitForFinished();
+                span.end();
                 QMessageBox::information(this, "Killed", "VM process terminated.");
             }
             runningProcs.remove(name);
+            qmpSockets.remove(name);
         } else {
+            span.end();
             QMessageBox::warning(this, "Info", "No running VM process found for this VM.");
         }
     }
@@ -619,6 +1920,7 @@ private slots:
         int sizeGB = QInputDialog::getInt(this, "Disk Size", "Enter size in GB:", 10, 1, 1024, 1, &ok);
         if (!ok) return;
 
+        TraceSpan span("onCreateDisk");
         QString qemuImg = findQemuImgExecutable();
         QStringList args;
         args << "create" << "-f" << "qcow2" << file << QString::number(sizeGB) + "G";
@@ -627,9 +1929,15 @@ private slots:
         proc.setProgram(qemuImg);
         proc.setArguments(args);
         proc.setProcessChannelMode(QProcess::ForwardedChannels);
-        proc.start();
+        bool finished;
+        {
+            TRACE_SCOPE("qemu-img create", file);
+            proc.start();
+            finished = proc.waitForFinished();
+        }
+        span.end();
 
-        if (!proc.waitForFinished()) {
+        if (!finished) {
             QMessageBox::critical(this, "Error", "Failed to create QCOW2 disk.");
             return;
         }
@@ -649,46 +1957,98 @@ private slots:
         QString folder = QFileDialog::getExistingDirectory(this, "Select export folder", QDir::homePath());
         if (folder.isEmpty()) return;
 
+        TraceSpan span("onExport");
         VM vm = vmFromSettings(name);
         QDir().mkpath(folder);
 
-        if (!vm.disk.isEmpty()) {
+        if (!vm.disk.isEmpty() && !vm.backing_disk.isEmpty()) {
+            // A VM taken from a pool only has an overlay on the template disk;
+            // export one standalone image instead. -U reads it while the VM runs.
+            QString dest = QDir(folder).filePath(QFileInfo(vm.disk).completeBaseName() + ".qcow2");
+            QString error;
+            if (!runQemuImg(QStringList() << "convert" << "-U" << "-O" << "qcow2" << vm.disk << dest, &error)) {
+                span.end();
+                QMessageBox::critical(this, "Export", QString("Could not flatten the disk of '%1':\n%2").arg(vm.name, error));
+                return;
+            }
+            vm.disk = dest;
+        } else if (!vm.disk.isEmpty()) {
             QString dest = QDir(folder).filePath(QFileInfo(vm.disk).fileName());
-            if (dest != vm.disk) QFile::copy(vm.disk, dest);
+            if (dest != vm.disk) { TRACE_SCOPE("QFile::copy", vm.disk); QFile::copy(vm.disk, dest); }
         }
         if (!vm.iso.isEmpty()) {
             QString dest = QDir(folder).filePath(QFileInfo(vm.iso).fileName());
-            if (dest != vm.iso) QFile::copy(vm.iso, dest);
-        }
-
-        QSettings exportSettings(QDir(folder).filePath(vm.name + ".ini"), QSettings::IniFormat);
-        exportSettings.beginGroup(vm.name);
-        exportSettings.setValue("disk", QFileInfo(vm.disk).fileName());
-        exportSettings.setValue("iso", QFileInfo(vm.iso).fileName());
-        exportSettings.setValue("mem", vm.mem);
-        exportSettings.setValue("cpu", vm.cpu);
-        exportSettings.setValue("net", vm.net ? 1 : 0);
-        exportSettings.setValue("audio", vm.audio ? 1 : 0);
-        exportSettings.setValue("hda", vm.hda ? 1 : 0);
-        exportSettings.setValue("vnc", vm.vnc ? 1 : 0);
-        exportSettings.setValue("vnc_port", vm.vnc_port);
-        exportSettings.setValue("vnc_pass", vm.vnc_pass ? 1 : 0);
-        exportSettings.setValue("accel_override", vm.accel_override ? 1 : 0);
-        exportSettings.setValue("accel_type", vm.accel_type);
-        exportSettings.setValue("custom_args", vm.custom_args); // NEW
-        exportSettings.endGroup();
-        exportSettings.sync();
+            if (dest != vm.iso) { TRACE_SCOPE("QFile::copy", vm.iso); QFile::copy(vm.iso, dest); }
+        }
+
+        vmToExportSettings(vm, folder);
+        span.end();
 
         QMessageBox::information(this, "Export", "Export complete.");
     }
 
+    void onIncrementalExport() {
+        auto item = listWidget->currentItem();
+        if (!item) return;
+        QString name = item->text();
+        VM vm = vmFromSettings(name);
+        if (!vm.hda || vm.disk.isEmpty()) {
+            QMessageBox::warning(this, "Incremental Export", "This VM has no primary HDD to export.");
+            return;
+        }
+        if (isRunning(name) && !qmpSockets.contains(name)) {
+            QMessageBox::warning(this, "Incremental Export", "This VM has no QMP connection. Restart it and try again.");
+            return;
+        }
+        if (exportsRunning.contains(name)) {
+            QMessageBox::information(this, "Incremental Export", "An export of this VM is already running.");
+            return;
+        }
+        QString folder = QFileDialog::getExistingDirectory(this, "Select export folder", QDir::homePath());
+        if (folder.isEmpty()) return;
+        TraceSpan span("onIncrementalExport");
+        QDir().mkpath(folder);
+
+        // Runs in the background; the result is reported when the job is done.
+        IncrementalExport *job = new IncrementalExport(vm, folder, isRunning(name) ? qmpSockets.value(name) : QString(), this);
+        exportsRunning.insert(name);
+        job->start([this, job, vm, folder](bool ok, const QString &error) {
+            job->deleteLater();
+            exportsRunning.remove(vm.name);
+            if (!ok) {
+                QMessageBox::critical(this, "Incremental Export", "Backup failed:\n" + error);
+                return;
+            }
+            QDir d(folder);
+            QStringList chain = job->chain();
+            {
+                TRACE_SCOPE("onIncrementalExport finish", vm.name);
+                vmToExportSettings(vm, folder, chain);
+                QSettings db(getDatabasePath(), QSettings::IniFormat);
+                db.setValue(vm.name + "/backup_last", d.filePath(job->targetName()));
+                db.sync();
+
+                if (!vm.iso.isEmpty()) {
+                    QString dest = d.filePath(QFileInfo(vm.iso).fileName());
+                    if (dest != vm.iso && !QFileInfo::exists(dest)) { TRACE_SCOPE("QFile::copy", vm.iso); QFile::copy(vm.iso, dest); }
+                }
+            }
+            QMessageBox::information(this, "Incremental Export",
+                                     QString("%1 export of '%2' complete: %3\nChain length: %4")
+                                         .arg(job->isIncremental() ? "Incremental" : "Full", vm.name, job->targetName()).arg(chain.size()));
+        });
+    }
+
     void onImport() {
         QString folder = QFileDialog::getExistingDirectory(this, "Select import folder", QDir::homePath());
         if (folder.isEmpty()) return;
 
+        TraceSpan span("onImport");
         QDir d(folder);
         QStringList files = d.entryList(QStringList() << "*.ini", QDir::Files);
-        if (files.isEmpty()) { QMessageBox::warning(this, "Import", "No INI file found."); return; }
+        if (files.isEmpty()) { span.end(); QMessageBox::warning(this, "Import", "No INI file found."); return; }
+
+        QStringList problems;
 
         for (const QString &file : files) {
             QSettings s(d.filePath(file), QSettings::IniFormat);
@@ -709,51 +2069,263 @@ private slots:
                 vm.accel_override = s.value("accel_override", 0).toInt() == 1;
                 vm.accel_type = s.value("accel_type", "default").toString();
                 vm.custom_args = s.value("custom_args", "").toString(); // NEW
+                vm.throttle = s.value("throttle", 0).toInt() == 1;
+                vm.throttle_bps = s.value("throttle_bps", 0).toInt();
+                vm.throttle_iops = s.value("throttle_iops", 0).toInt();
+                vm.throttle_bps_max = s.value("throttle_bps_max", 0).toInt();
+                vm.throttle_iops_max = s.value("throttle_iops_max", 0).toInt();
+                vm.throttle_burst_len = s.value("throttle_burst_len", 1).toInt();
+                vm.pool_size = s.value("pool_size", 0).toInt();
+                vm.pool_mem_limit = s.value("pool_mem_limit", 0).toInt();
+                vm.pool_boot_secs = s.value("pool_boot_secs", 0).toInt();
+                vm.profile = s.value("profile", "desktop").toString();
+                vm.kernel = s.value("kernel", "").toString();
+                vm.initrd = s.value("initrd", "").toString();
+                vm.kernel_append = s.value("kernel_append", "").toString();
+                QStringList backupChain = s.value("backup_chain").toStringList();
                 s.endGroup();
 
                 QString exeDir = QCoreApplication::applicationDirPath();
-                if (!vm.disk.isEmpty()) {
-                    QString src = d.filePath(vm.disk);
-                    QString dest = QDir(exeDir).filePath(QFileInfo(vm.disk).fileName());
-                    if (QFileInfo::exists(src)) {
-                        QFile::copy(src, dest);
+                if (!backupChain.isEmpty()) {
+                    // Incremental export: flatten the image chain into one standalone disk.
+                    QString src = d.filePath(backupChain.last());
+                    QString dest = uniqueFilePath(QDir(exeDir), QFileInfo(vm.disk).completeBaseName() + ".qcow2");
+                    QString error;
+                    for (const QString &link : backupChain) {
+                        if (error.isEmpty() && !d.exists(link)) error = "Missing backup image: " + d.filePath(link);
+                    }
+                    if (error.isEmpty() && runQemuImg(QStringList() << "convert" << "-O" << "qcow2" << src << dest, &error)) {
                         vm.disk = dest;
                     } else {
+                        problems << QString("Could not restore the disk of '%1' from its backup chain.\n%2").arg(vm.name, error);
                         vm.disk.clear();
                     }
+                } else if (!vm.disk.isEmpty()) {
+                    QString src = d.filePath(vm.disk);
+                    QString dest = uniqueFilePath(QDir(exeDir), QFileInfo(vm.disk).fileName());
+                    bool copied = false;
+                    if (QFileInfo::exists(src)) {
+                        TRACE_SCOPE("QFile::copy", src);
+                        copied = QFile::copy(src, dest);
+                        if (!copied) problems << QString("Could not copy the disk of '%1' to %2.").arg(vm.name, dest);
+                    }
+                    if (copied) vm.disk = dest;
+                    else vm.disk.clear();
                 }
                 if (!vm.iso.isEmpty()) {
                     QString src = d.filePath(vm.iso);
-                    QString dest = QDir(exeDir).filePath(QFileInfo(vm.iso).fileName());
+                    QString dest = uniqueFilePath(QDir(exeDir), QFileInfo(vm.iso).fileName());
+                    bool copied = false;
                     if (QFileInfo::exists(src)) {
-                        QFile::copy(src, dest);
-                        vm.iso = dest;
-                    } else {
-                        vm.iso.clear();
+                        TRACE_SCOPE("QFile::copy", src);
+                        copied = QFile::copy(src, dest);
+                        if (!copied) problems << QString("Could not copy the ISO of '%1' to %2.").arg(vm.name, dest);
                     }
+                    if (copied) vm.iso = dest;
+                    else vm.iso.clear();
                 }
 
                 vmToSettings(vm);
+                syncPool(vm.name, vm);
             }
         }
         loadList();
+        span.end();
+        if (!problems.isEmpty())
+            QMessageBox::warning(this, "Import", problems.join("\n\n"));
         QMessageBox::information(this, "Import", "Import complete.");
     }
 
+    void onDiskStats() {
+        auto item = listWidget->currentItem();
+        if (!item) return;
+        QString name = item->text();
+        if (!isRunning(name) || !qmpSockets.contains(name)) {
+            QMessageBox::warning(this, "Info", "No running VM process found for this VM.");
+            return;
+        }
+        if (exportBusy(name, "Disk Stats")) return;
+
+        TraceSpan span("onDiskStats");
+
+        QString error;
+        QJsonValue result = qmpExecute(qmpSockets.value(name), "query-blockstats", QJsonObject(), &error);
+        if (result.isUndefined()) {
+            span.end();
+            QMessageBox::critical(this, "Error", "query-blockstats failed:\n" + error);
+            return;
+        }
+
+        QString report;
+        for (const QJsonValue &entry : result.toArray()) {
+            QJsonObject dev = entry.toObject();
+            QString label = dev.value("qdev").toString();
+            if (label.isEmpty()) label = dev.value("device").toString();
+            if (label.isEmpty()) continue;
+            QJsonObject st = dev.value("stats").toObject();
+            report += QString("%1\n  read: %2 ops, %3 MB   write: %4 ops, %5 MB\n")
+                          .arg(label)
+                          .arg(st.value("rd_operations").toDouble(), 0, 'f', 0)
+                          .arg(st.value("rd_bytes").toDouble() / (1024 * 1024), 0, 'f', 1)
+                          .arg(st.value("wr_operations").toDouble(), 0, 'f', 0)
+                          .arg(st.value("wr_bytes").toDouble() / (1024 * 1024), 0, 'f', 1);
+            bool hasHistogram = false;
+            for (const char *kind : {"rd", "wr"}) {
+                QJsonObject hist = st.value(QString("%1_latency_histogram").arg(kind)).toObject();
+                if (hist.isEmpty()) continue;
+                hasHistogram = true;
+                QJsonArray bounds = hist.value("boundaries").toArray();
+                QJsonArray bins = hist.value("bins").toArray();
+                QStringList cells;
+                for (int i = 0; i < bins.size(); ++i) {
+                    QString upper = i < bounds.size() ? QString("<%1us").arg(bounds[i].toDouble() / 1000, 0, 'f', 0) : "rest";
+                    cells << QString("%1: %2").arg(upper).arg(bins[i].toDouble(), 0, 'f', 0);
+                }
+                report += QString("  %1 latency: %2\n").arg(kind, cells.join(", "));
+            }
+            if (!hasHistogram && dev.value("device").toString() == primaryDriveId) report += "  (no latency histograms; they could not be enabled at launch)\n";
+        }
+        span.end();
+        QMessageBox::information(this, "Disk Stats", report.isEmpty() ? "No block devices reported." : report);
+    }
+
+    void onTakeFromPool() {
+        TraceSpan span("onTakeFromPool");
+        auto item = listWidget->currentItem();
+        if (!item) return;
+        QString name = item->text();
+        VMPool *pool = pools.value(name);
+        if (!pool) {
+            span.end();
+            QMessageBox::warning(this, "Pool", "No pool is configured for this VM. Set \"Pool Size\" in Edit VM.");
+            return;
+        }
+
+        VMPool::Instance inst;
+        if (!pool->take(&inst)) {
+            span.end();
+            QString message = "No pooled instance is ready yet; the pool is still filling.";
+            if (!pool->lastError().isEmpty()) message += "\n\nLast pool error:\n" + pool->lastError();
+            QMessageBox::information(this, "Pool", message);
+            return;
+        }
+
+        // The instance already runs with its final name and disk; it only needs registering and resuming.
+        VM vm = pool->templ();
+        vm.name = inst.name;
+        vm.disk = inst.overlay;
+        vm.backing_disk = pool->templ().disk;
+        if (inst.vncPort) vm.vnc_port = inst.vncPort;
+        vm.pool_size = 0;
+        vmToSettings(vm);
+        inst.proc->setParent(this);
+        runningProcs[vm.name] = inst.proc;
+        qmpSockets[vm.name] = inst.qmpSocket;
+        loadList();
+
+        QString error;
+        bool resumed = !qmpExecute(inst.qmpSocket, "cont", QJsonObject(), &error).isUndefined();
+        // Throttle edits since the instance was started are applied on hand-out.
+        bool throttled = !resumed || sameThrottle(inst.launchedAs, vm) || applyIoThrottle(inst.qmpSocket, vm, &error);
+        span.end();
+        if (!resumed)
+            QMessageBox::warning(this, "Pool", QString("VM '%1' was created but could not be resumed:\n%2").arg(vm.name, error));
+        else if (!throttled)
+            QMessageBox::warning(this, "I/O Throttle", QString("VM '%1' is running, but its I/O limits could not be updated:\n%2").arg(vm.name, error));
+    }
+
+    void onToggleTrace() {
+        if (!Trace::isEnabled()) {
+            Trace::clear();
+            Trace::setEnabled(true);
+            traceBtn->setText("Stop Trace");
+            return;
+        }
+
+        Trace::setEnabled(false);
+        traceBtn->setText("Start Trace");
+        QString file = QFileDialog::getSaveFileName(this, "Save Trace", QDir::homePath() + "/qmgr-trace.json",
+                                                    "Chrome Trace JSON (*.json)");
+        if (file.isEmpty()) return;
+        if (!Trace::writeJson(file)) {
+            QMessageBox::critical(this, "Error", "Failed to write trace file:\n" + file);
+            return;
+        }
+        QMessageBox::information(this, "Trace", "Trace saved. Open it in chrome://tracing or ui.perfetto.dev:\n" + file);
+    }
+
 private:
     QListWidget *listWidget;
-    QPushButton *createBtn, *editBtn, *renameBtn, *launchBtn, *killBtn, *deleteBtn, *createDiskBtn, *exportBtn, *importBtn, *quitBtn;
+    QPushButton *createBtn, *editBtn, *renameBtn, *launchBtn, *killBtn, *deleteBtn, *createDiskBtn, *exportBtn, *incExportBtn, *importBtn, *diskStatsBtn, *takePoolBtn, *traceBtn, *quitBtn;
     QMap<QString, QProcess*> runningProcs;
+    QMap<QString, QString> qmpSockets; // QMP endpoint per running VM
+    QMap<QString, VMPool*> pools;    // pre-launched instances per template VM
+    QSet<QString> exportsRunning;    // VMs with an incremental export in progress
+
+    void stopPool(const QString &name) {
+        delete pools.take(name);
+    }
+
+    // (Re)starts the pool for a template after its settings changed or it was renamed.
+    void syncPool(const QString &oldName, const VM &vm) {
+        stopPool(oldName);
+        stopPool(vm.name);
+        if (vm.pool_size > 0 && vm.hda && !vm.disk.isEmpty())
+            pools[vm.name] = new VMPool(vm, this);
+    }
+
+    // Registered VMs whose disk is a pool overlay on top of disk.
+    static QStringList overlayUsers(const QString &disk) {
+        QStringList users;
+        if (disk.isEmpty()) return users;
+        const QString path = QFileInfo(disk).absoluteFilePath();
+        for (const QString &vmName : vmNames()) {
+            QString backing = vmFromSettings(vmName).backing_disk;
+            if (!backing.isEmpty() && QFileInfo(backing).absoluteFilePath() == path) users << vmName;
+        }
+        return users;
+    }
+
+    // True when a running pool for a can carry on for b: instances would be launched
+    // the same way, apart from throttle limits, which are applied on take.
+    static bool samePoolLaunch(VM a, VM b) {
+        if (a.name != b.name || a.disk != b.disk || a.pool_boot_secs != b.pool_boot_secs) return false;
+        for (VM *vm : {&a, &b}) {
+            vm->throttle = false;
+            vm->backing_disk.clear();
+        }
+        return buildQemuArgs(a, "qmp") == buildQemuArgs(b, "qmp");
+    }
+
+    // An incremental export holds the VM's disk (or its QMP monitor) until it finishes.
+    bool exportBusy(const QString &name, const QString &title) {
+        if (!exportsRunning.contains(name)) return false;
+        QMessageBox::information(this, title, "An incremental export of this VM is running. Try again when it has finished.");
+        return true;
+    }
+
+    bool isRunning(const QString &name) const {
+        QProcess *proc = runningProcs.value(name);
+        return proc && proc->state() != QProcess::NotRunning;
+    }
 };
 
 int main(int argc, char **argv) {
     QCoreApplication::setOrganizationName("YourOrganization");
     QCoreApplication::setApplicationName("QMGR");
 
+    // QMGR_TRACE=<file> traces the whole session and writes it on exit.
+    const QString tracePath = qEnvironmentVariable("QMGR_TRACE");
+    if (!tracePath.isEmpty()) Trace::setEnabled(true);
+
     QApplication app(argc, argv);
     MainWindow w;
     w.show();
-    return app.exec();
+    int rc = app.exec();
+
+    if (!tracePath.isEmpty() && !Trace::writeJson(tracePath))
+        QMessageBox::critical(nullptr, "Error", "Failed to write trace file:\n" + tracePath);
+    return rc;
 }
 
 #include "qmgr.moc"
@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# Compares QMGR's launch profiles (desktop, server, microvm) on one guest.
+#
+#   Boot time: boots the guest RUNS times per profile with
+#   systemd.unit=poweroff.target and times QEMU from start to exit.
+#   Idle CPU:  boots it once more normally, waits SETTLE seconds, then samples
+#   the QEMU process's CPU use for IDLE seconds (pidstat if installed,
+#   /proc/<pid>/stat otherwise).
+#
+# All profiles boot the same kernel directly, so the numbers show what the
+# profile's device set costs. The QEMU arguments mirror buildQemuArgs() in
+# qmgr.cpp; keep them in sync when that changes. The disk is opened with
+# -snapshot, so it is never modified.
+#
+# Usage: scripts/bench-profiles.sh -k KERNEL -d DISK [-i INITRD] [-p ROOTPART]
+#                                   [-n RUNS] [-s SETTLE] [-t IDLE] [-m MEM]
+#   -p  partition suffix of the root file system on DISK, e.g. 1 for /dev/vda1
+#
+# Environment: QEMU (default qemu-system-x86_64), DESKTOP_DISPLAY (default
+# sdl; use none on a machine without a display, which leaves out SDL's cost).
+
+set -euo pipefail
+
+QEMU=${QEMU:-qemu-system-x86_64}
+DESKTOP_DISPLAY=${DESKTOP_DISPLAY:-sdl}
+KERNEL= INITRD= DISK= ROOTPART= RUNS=5 SETTLE=60 IDLE=60 MEM=1024
+
+usage() { sed -n '2,/^$/s/^# \{0,1\}//p' "$0"; exit "${1:-1}"; }
+
+while getopts "k:i:d:p:n:s:t:m:h" opt; do
+    case $opt in
+        k) KERNEL=$OPTARG ;;
+        i) INITRD=$OPTARG ;;
+        d) DISK=$OPTARG ;;
+        p) ROOTPART=$OPTARG ;;
+        n) RUNS=$OPTARG ;;
+        s) SETTLE=$OPTARG ;;
+        t) IDLE=$OPTARG ;;
+        m) MEM=$OPTARG ;;
+        h) usage 0 ;;
+        *) usage ;;
+    esac
+done
+[[ -n $KERNEL && -n $DISK ]] || usage
+command -v "$QEMU" >/dev/null || { echo "$QEMU not found" >&2; exit 1; }
+
+if [[ -w /dev/kvm ]]; then ACCEL=kvm; else ACCEL=tcg; echo "note: /dev/kvm not usable, using tcg" >&2; fi
+
+# QEMU arguments for a profile; $1 = profile, $2 = extra kernel arguments.
+profile_args() {
+    local profile=$1 extra=$2 root
+    local -a args=()
+    case $profile in
+        microvm) args+=(-machine microvm -nodefaults -no-user-config) ;;
+        server)  args+=(-machine q35) ;;
+    esac
+    args+=(-accel "$ACCEL" -m "$MEM" -cpu qemu64 -kernel "$KERNEL")
+    [[ -n $INITRD ]] && args+=(-initrd "$INITRD")
+    if [[ $profile == desktop ]]; then root=/dev/sda$ROOTPART; else root=/dev/vda$ROOTPART; fi
+    args+=(-append "console=ttyS0 root=$root ro $extra")
+    args+=(-drive "file=$DISK,if=none,id=hd0,snapshot=on")
+    case $profile in
+        desktop) args+=(-device ide-hd,drive=hd0,bus=ide.0,unit=0,id=disk0
+                        -boot menu=on -vga std -usb -device usb-tablet
+                        -net nic -net user -display "$DESKTOP_DISPLAY" -serial file:/dev/null) ;;
+        server)  args+=(-device virtio-blk-pci,drive=hd0,id=disk0
+                        -netdev user,id=net0 -device virtio-net-pci,netdev=net0
+                        -display none -vga none -serial file:/dev/null) ;;
+        microvm) args+=(-device virtio-blk-device,drive=hd0,id=disk0
+                        -netdev user,id=net0 -device virtio-net-device,netdev=net0
+                        -display none -serial file:/dev/null) ;;
+    esac
+    args+=(-monitor none -no-reboot)
+    printf '%s\0' "${args[@]}"
+}
+
+now() { date +%s.%N; }
+
+boot_seconds() {
+    local -a args
+    mapfile -d '' args < <(profile_args "$1" "systemd.unit=poweroff.target")
+    local start end
+    start=$(now)
+    timeout 600 "$QEMU" "${args[@]}" </dev/null >/dev/null 2>&1 || { echo "boot of $1 failed or timed out" >&2; return 1; }
+    end=$(now)
+    awk -v s="$start" -v e="$end" 'BEGIN { printf "%.3f", e - s }'
+}
+
+# Average %CPU of one core used by pid over $2 seconds.
+cpu_percent() {
+    local pid=$1 secs=$2
+    if command -v pidstat >/dev/null; then
+        pidstat -p "$pid" "$secs" 1 | awk '/^Average:/ { print $(NF-2) }'
+        return
+    fi
+    local hz t0 t1
+    hz=$(getconf CLK_TCK)
+    t0=$(awk '{ print $14 + $15 }' "/proc/$pid/stat")
+    sleep "$secs"
+    t1=$(awk '{ print $14 + $15 }' "/proc/$pid/stat")
+    awk -v a="$t0" -v b="$t1" -v hz="$hz" -v s="$secs" 'BEGIN { printf "%.1f", (b - a) * 100 / (hz * s) }'
+}
+
+idle_cpu() {
+    local -a args
+    mapfile -d '' args < <(profile_args "$1" "")
+    "$QEMU" "${args[@]}" </dev/null >/dev/null 2>&1 &
+    local pid=$!
+    sleep "$SETTLE"
+    if ! kill -0 "$pid" 2>/dev/null; then echo "QEMU for $1 exited early" >&2; return 1; fi
+    cpu_percent "$pid" "$IDLE"
+    kill "$pid"
+    wait "$pid" 2>/dev/null || true
+}
+
+printf '%-8s %10s %10s %10s %12s\n' profile "boot avg" "boot min" "boot max" "idle %CPU"
+for profile in desktop server microvm; do
+    times=()
+    for ((run = 1; run <= RUNS; ++run)); do times+=("$(boot_seconds "$profile")"); done
+    stats=$(printf '%s\n' "${times[@]}" | awk 'NR == 1 { min = max = $1 } { sum += $1; if ($1 < min) min = $1; if ($1 > max) max = $1 }
+                                              END { printf "%.2f %.2f %.2f", sum / NR, min, max }')
+    read -r avg min max <<<"$stats"
+    cpu=$(idle_cpu "$profile")
+    printf '%-8s %9ss %9ss %9ss %12.1f\n' "$profile" "$avg" "$min" "$max" "$cpu"
+done